@@ -0,0 +1,90 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include "drivers/soft_timer.h"
+#include "led.h"
+
+//==============================================================================
+// Animation Class Declaration
+// Description: Keyframe player for any number of LEDs (up to MAX_TRACKS). A
+//              pattern is a list of keyframes, each fading from the previous
+//              level to its own over a duration with an easing curve. The
+//              built-in patterns live in flash, one user pattern can be
+//              loaded into RAM over serial (in chunks, see load()). One
+//              soft timer updates all playing LEDs, and only those
+//              (O(active) per tick).
+//==============================================================================
+class Animation {
+public:
+    enum Easing : uint8_t {
+        STEP,        // Hold the previous level, jump at the end
+        LINEAR,
+        EASE_IN,     // Quadratic, slow start
+        EASE_OUT,    // Quadratic, slow end
+        EASE_IN_OUT  // Smoothstep
+    };
+
+    enum Patterns { BREATHE, HEARTBEAT, BLINK, FLASH, FADE_IN, USER, 
+                    PATTERN_COUNT };
+
+    // Keyframe (4 bytes, also the serial load format)
+    struct Keyframe {
+        uint8_t  level;    // Target level (0-255)
+        uint8_t  easing;   // Easing towards the target
+        uint16_t duration; // Transition time (ms)
+    };
+
+    // Pattern (keyframes in flash, except for USER)
+    struct Pattern {
+        const Keyframe* frames;
+        uint8_t count;
+        bool loop;         // Restart after the last keyframe, else hold it
+    };
+
+    static constexpr uint8_t MAX_TRACKS = 8;       // LEDs playing at once
+    static constexpr uint8_t MAX_USER_FRAMES = 16; // USER pattern length
+
+    // Keyframes per ANIM_LOAD frame: frame_max less the CRC, the opcode and
+    // the loop / index bytes (see load())
+    static constexpr uint8_t LOAD_FRAMES = (Serial::frame_max - 5) / 4;
+    static_assert(LOAD_FRAMES >= 1, "Serial frames too small for a keyframe");
+    static constexpr uint16_t TICK_MS = 10;        // Update period
+
+    // Public methods
+    static bool play(LED &led, uint8_t pattern, uint16_t offset_ms = 0);
+    static void stop(LED &led);
+    static void stop_all();
+    static bool is_playing(const LED &led);
+    static uint8_t active_count() { return _active; }
+    static bool load(const uint8_t* data, uint8_t length);
+
+private:
+    struct Track {
+        LED*     led;
+        uint8_t  pattern;
+        uint8_t  frame;   // Current keyframe
+        uint8_t  from;    // Level at the start of the keyframe
+        uint16_t elapsed; // Time into the keyframe (ms)
+    };
+
+    static Track _tracks[MAX_TRACKS]; // Playing tracks first, [0, _active)
+    static uint8_t _active;
+    static SoftTimer _tick;
+    static uint32_t _last_ms;         // SystemClock::millis() at the last tick
+
+    static Keyframe _user_frames[MAX_USER_FRAMES];
+    static uint8_t _user_count;
+    static bool _user_loop;
+
+    static void _update(void* context);
+    static bool _advance(Track &track, uint16_t dt);
+    static void _remove(uint8_t index);
+    static void _pattern(uint8_t pattern, Pattern &out);
+    static void _keyframe(uint8_t pattern, const Pattern &p, uint8_t index,
+                          Keyframe &out);
+    static uint16_t _ease(uint8_t easing, uint16_t t);
+};
+
+#endif // ANIMATION_H
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include "drivers/gpio.h"
-#include "drivers/timer.h"
+#include "drivers/soft_timer.h"
 #include "drivers/serial.h"
 
 //==============================================================================
@@ -18,13 +18,15 @@ public:
     // Public Methods
     void init();
     bool is_pressed();
-    void print_presses(const uint16_t &interval, Timer &timer, Serial &serial);
+    void print_presses(const uint16_t &interval, Serial &serial);
+    void stop_report();
 
 private:
     // Private Members
     GPIO _gpio;
     uint8_t _pin;
     volatile uint32_t _button_presses;
+    SoftTimer _report_timer; // Press report period
     
     // Compile time validation
     static constexpr bool _valid_btn_pin(uint8_t pin);
@@ -2,22 +2,48 @@
 #define CMD_H
 
 #include <avr/io.h>
-#include <string.h> // strncmp
-#include <stdio.h>  // sscanf
+#include <string.h> // strncmp_P
+#include <avr/pgmspace.h>
+#include "drivers/serial.h"
 
 //==============================================================================
 // CMD Class Declaration
 //==============================================================================
 class Command {
 public:
-    enum Commands { NO_CMD, LED_BLINK, LED_ADC, LED_PWR, BUTTON, LED_RAMP };
+    enum Commands { NO_CMD, LED_BLINK, LED_ADC, LED_PWR, BUTTON, LED_RAMP, CAPTURE,
+                    SCOPE, ANIMATE };
 
-    void parse_cmd(const char* cmd);
+    // Queries report status (or load data) without changing the running 
+    // command
+    enum Queries { NO_QUERY, UART_STATS, CPU_LOAD, ANIM_LOAD };
+
+    // Binary frame opcodes: a Commands value, or FRAME_QUERY | Queries value.
+    // Replies: ACK echoes the opcode (followed by the query data, if any),
+    // NAK carries the number of invalid frames received so far (uint16_t,
+    // little-endian)
+    static constexpr uint8_t FRAME_QUERY = 0x40;
+    static constexpr uint8_t FRAME_ACK = 0x80;
+    static constexpr uint8_t FRAME_NAK = 0xFF;
+
+    // SCOPE replies with ADC capture blocks: FRAME_ACK | SCOPE, block index,
+    // pre-trigger samples, then SCOPE_BLOCK 8-bit samples (oldest first)
+    static constexpr uint8_t SCOPE_BLOCK = 64;
+
+    void parse_cmd(const LineView& line);
+    bool parse_frame(const uint8_t* frame, uint8_t length);
 
     uint8_t cmd = LED_BLINK;
+    uint8_t query = NO_QUERY;
     char cmd_string[20];
     uint16_t cmd_val1;
     uint16_t cmd_val2;
+    const uint8_t* data = nullptr; // Query payload (in the parsed frame)
+    uint8_t data_length = 0;
+
+private:
+    static bool _is_space(char c);
+    static bool _is_digit(char c);
 };
 
 #endif // CMD_PARSER_H
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define ADC_H
 
 #include <avr/io.h>
+#include "fixed_point.h"
 
 //==============================================================================
 // ADC Class Declaration
@@ -11,12 +12,146 @@ public:
     static constexpr int MAX_INPUT_VOLTAGE = 5000;  // Maximum input voltage(mV)
     static constexpr int MAX_ADC_VALUE = 1023;      // Maximum ADC value
 
+    // Completed conversion (non-blocking mode)
+    struct Sample {
+        uint16_t value;   // ADC result
+        uint8_t channel;  // Converted channel
+        uint8_t seq;      // Sequence number (1-255, increments per result)
+    };
+
+    // Conversion complete callback (runs in ADC_vect)
+    typedef void (*Callback)(uint8_t channel, uint16_t value);
+
     // Constructor
     ADConverter();
 
     // Public Methods
     uint16_t read_channel(uint8_t ch);
-    void convert_to_mv(uint16_t &adc_value);
+    uint16_t read_channel_quiet(uint8_t ch);
+    void convert_to_mv(uint16_t &adc_value, uint8_t extra_bits = 0);
+
+    // Non-blocking conversion
+    bool start_conversion(uint8_t ch);
+    static bool is_busy();
+    bool get_sample(Sample &sample);
+    void set_callback(Callback callback);
+
+    // ADC interrupt handler
+    static void handle_conversion_complete();
+
+private:
+    static volatile uint16_t _value;   // Last result
+    static volatile uint8_t _channel;  // Channel of the last result
+    static volatile uint8_t _seq;      // Result sequence number (0 = none)
+    static volatile bool _busy;        // Non-blocking conversion running
+    static Callback _callback;
+};
+
+//==============================================================================
+// ADCScanner Class Declaration
+// Description: Timer triggered scan of a list of ADC channels. The ADC auto
+//              trigger (ADTS) starts one scan step per timer compare match,
+//              so every channel is sampled at exactly trigger rate / count
+//              without CPU pacing. After a mux switch the first conversion
+//              is discarded and the ISR converts again at once (settling),
+//              so each step takes two conversions (~208us at /128).
+//              Results go to per-channel double-buffered slots: the ISR
+//              fills one slot while readers get the other, so reads are
+//              never torn and need no locking.
+//              With oversampling, 4^n conversions per channel are summed
+//              and decimated (>> n) into one 10+n bit result (n <= 3), at
+//              1/4^n of the rate. Input noise of about 1 LSB is required.
+//              The timer 1 trigger claims timer 1 (CTC, OCR1B = OCR1A) for
+//              a period_us step period and is cleared by the ADC ISR, as the
+//              ADC only starts on a rising edge of OCF1B.
+//==============================================================================
+class ADCScanner {
+public:
+    static constexpr uint8_t MAX_CHANNELS = 8;
+    static constexpr uint8_t MAX_OVERSAMPLE = 3; // 13-bit results
+
+    // Auto trigger sources (ADTS bits)
+    enum Trigger {
+        TRIGGER_TIMER0_COMPA = (1 << ADTS1) | (1 << ADTS0), // SystemClock tick (1kHz)
+        TRIGGER_TIMER1_COMPB = (1 << ADTS2) | (1 << ADTS0)  // Timer 1 OCR1B match
+    };
+
+    // Public Methods
+    static bool start(const uint8_t* channels, uint8_t count, 
+                      Trigger trigger = TRIGGER_TIMER0_COMPA,
+                      uint8_t oversample = 0, uint16_t period_us = 1000);
+    static void stop();
+    static bool is_running();
+    static bool read(uint8_t ch, uint16_t &value, uint8_t &seq);
+
+    // ADC interrupt handler
+    static void handle_conversion_complete();
+
+private:
+    static uint8_t _channels[MAX_CHANNELS];      // Scan list (ADMUX channels)
+    static uint8_t _count;                       // Channels in the scan list
+    static uint8_t _trigger;                     // Trigger (ADTS bits)
+    static volatile uint8_t _pos;                // Channel being converted
+    static volatile bool _settling;              // Discard the next result
+    static volatile bool _running;
+    static volatile uint16_t _slots[MAX_CHANNELS][2]; // Double-buffered results
+    static volatile uint8_t _latest[MAX_CHANNELS];    // Slot with the last result
+    static volatile uint8_t _seq[MAX_CHANNELS];       // Results per channel (0 = none)
+    static uint8_t _oversample;                  // Extra bits (4^n samples)
+    static uint16_t _acc[MAX_CHANNELS];          // Oversampling sums
+    static uint8_t _acc_count[MAX_CHANNELS];     // Samples in the sums
+};
+
+//==============================================================================
+// ADCCapture Class Declaration
+// Description: High-speed burst capture of one channel into RAM, as a poor
+//              man's oscilloscope. The ADC runs free and left adjusted, the
+//              ISR stores 8-bit samples (ADCH) in a 256 byte ring. The first
+//              pre_trigger samples are always kept before the trigger (the
+//              first rising crossing of threshold, or at once if threshold
+//              is 0), and the capture stops when the ring holds pre_trigger
+//              samples before and the rest after the trigger. At /16 the
+//              rate is 1MHz / 13 = 76.9 kSPS (8-bit accuracy) with ~208 CPU
+//              cycles per sample, so other ISRs must stay short. Samples
+//              serviced after the next conversion has already completed are
+//              counted by late_count(), as the capture may have lost one.
+//==============================================================================
+class ADCCapture {
+public:
+    static constexpr uint16_t BUFFER_SIZE = 256; // Samples per capture
+
+    // ADC clock prescaler (ADPS bits), sample rate = F_CPU / div / 13
+    enum Prescaler {
+        DIV_16  = (1 << ADPS2),
+        DIV_32  = (1 << ADPS2) | (1 << ADPS0),
+        DIV_64  = (1 << ADPS2) | (1 << ADPS1),
+        DIV_128 = (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0)
+    };
+    enum State { IDLE, PRE_TRIGGER, ARMED, TRIGGERED, DONE };
+
+    // Public Methods
+    static bool start(uint8_t ch, Prescaler prescaler, uint8_t threshold,
+                      uint8_t pre_trigger);
+    static void stop();
+    static bool is_running();
+    static bool is_done();
+    static uint8_t sample(uint8_t index); // Oldest first (valid when done)
+    static uint32_t sample_rate();
+    static uint16_t late_count();        // Late samples of the last capture
+
+    // ADC interrupt handler
+    static void handle_conversion_complete();
+
+private:
+    static uint8_t _buffer[BUFFER_SIZE];
+    static volatile uint8_t _pos;        // Next ring position
+    static volatile uint8_t _state;
+    static volatile uint16_t _remaining; // Samples until the next state
+    static volatile uint16_t _late;      // Samples serviced too late
+    static uint8_t _threshold;
+    static uint8_t _pre_trigger;
+    static uint8_t _prev;                // Previous sample (edge detection)
+    static uint8_t _prescaler;
 };
 
 #endif // ADC_H
\ No newline at end of file
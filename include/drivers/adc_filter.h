@@ -0,0 +1,98 @@
+#ifndef ADC_FILTER_H
+#define ADC_FILTER_H
+
+#include <avr/io.h>
+
+//==============================================================================
+// MovingAverage Template Declaration
+// Description: Boxcar average over the last size samples (a power of two),
+//              kept as a running sum so each update is one add, one
+//              subtract and one shift. Until the window is full the average
+//              of the samples so far is returned.
+//==============================================================================
+template <uint8_t size>
+class MovingAverage {
+public:
+    static_assert(size >= 2 && (size & (size - 1)) == 0,
+                  "MovingAverage size must be a power of two (2-128)");
+
+    uint16_t update(uint16_t sample) {
+        _sum += sample;
+        _sum -= _samples[_pos];
+        _samples[_pos] = sample;
+        _pos = (_pos + 1) & (size - 1);
+        if (_count < size) _count++;
+        return (_count == size) ? (uint16_t)(_sum / size) 
+                                : (uint16_t)(_sum / _count);
+    }
+
+    void reset() { *this = MovingAverage(); }
+
+private:
+    uint16_t _samples[size] = {};
+    uint32_t _sum = 0;
+    uint8_t _pos = 0;
+    uint8_t _count = 0;
+};
+
+//==============================================================================
+// IIRFilter Template Declaration
+// Description: Single-pole low-pass y += (x - y) / 2^shift. The state keeps
+//              shift fractional bits, so small steps are not lost to
+//              rounding. The time constant is about 2^shift samples. The
+//              first sample initializes the output.
+//==============================================================================
+template <uint8_t shift>
+class IIRFilter {
+public:
+    static_assert(shift >= 1 && shift <= 15, "IIRFilter shift must be 1-15");
+
+    uint16_t update(uint16_t sample) {
+        if (!_primed) {
+            _state = (uint32_t)sample << shift;
+            _primed = true;
+        } else {
+            _state += sample - (int32_t)(_state >> shift);
+        }
+        return (uint16_t)((_state + (1UL << (shift - 1))) >> shift); // Rounded
+    }
+
+    void reset() { _primed = false; }
+
+private:
+    uint32_t _state = 0; // Output with shift fractional bits
+    bool _primed = false;
+};
+
+//==============================================================================
+// Hysteresis Class Declaration
+// Description: Holds a derived value until the input moves more than band
+//              away from it, so noise around a step boundary does not make
+//              the output (and everything reported from it) flicker. The
+//              ends of the range (0 and max) are always taken at once, an
+//              input settling there is never held one band away from them.
+//==============================================================================
+class Hysteresis {
+public:
+    constexpr explicit Hysteresis(uint16_t band) : _band(band) {}
+
+    constexpr uint16_t update(uint16_t value, uint16_t max = UINT16_MAX) {
+        if (value > max) value = max;
+        if (!_primed || value == 0 || value == max ||
+            value > (uint32_t)_output + _band || 
+            (uint32_t)value + _band < _output) {
+            _output = value;
+            _primed = true;
+        }
+        return _output;
+    }
+
+    constexpr uint16_t value() const { return _output; }
+
+private:
+    uint16_t _band;
+    uint16_t _output = 0;
+    bool _primed = false;
+};
+
+#endif // ADC_FILTER_H
\ No newline at end of file
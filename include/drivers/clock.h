@@ -0,0 +1,47 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <avr/io.h>
+#include "drivers/timer.h"
+
+//==============================================================================
+// SystemClock Class Declaration
+// Description: Free-running millisecond/microsecond time base on timer 0
+//              (CTC, 1ms compare interrupt). All reads are interrupt safe
+//              and the elapsed helpers are wrap-safe, so every subsystem can
+//              share one clock without resetting each other's counters.
+//==============================================================================
+class SystemClock {
+public:
+    // Timer 0 settings for the 1ms tick (solved at compile time)
+    static constexpr Timer::TimerSettings tick = 
+        Timer::solve(Timer::TIMER0, Timer::MILLIS, 1);
+    static constexpr uint16_t US_PER_COUNT = 1000 / (tick.ocr + 1);
+
+    static_assert(tick.prescaler != 0 && tick.divisor == 1 && tick.error_ppm == 0,
+                  "F_CPU does not allow an exact 1ms tick on timer 0");
+    static_assert(1000 % (tick.ocr + 1) == 0,
+                  "F_CPU does not allow whole microseconds per timer 0 count");
+
+    typedef Timer::Callback Callback;
+
+    // Public methods
+    static void init();
+    static uint32_t millis();
+    static uint32_t micros();
+    static uint32_t elapsed_ms(uint32_t since);
+    static uint32_t elapsed_us(uint32_t since);
+    static bool has_elapsed(uint32_t &since, uint32_t interval);
+    static void attach(Callback on_tick);
+    static void detach();
+    static void detach(Callback on_tick);
+
+    // Timer interrupt handler (called from TIMER0_COMPA_vect)
+    static void handle_tick();
+
+private:
+    static volatile uint32_t _millis; // Milliseconds since init()
+    static volatile Callback _on_tick; // Called from the tick ISR
+};
+
+#endif // CLOCK_H
\ No newline at end of file
@@ -5,6 +5,9 @@
 
 //=============================================================================
 // GPIO Class Declaration
+// Description: Run-time GPIO pin. The registers are resolved once in the
+//              constructor. For pins known at compile time use Pin<Port, Bit>
+//              or DigitalPin<N> (drivers/pin.h), which need no storage.
 //=============================================================================
 class GPIO {
 public:
@@ -23,9 +26,16 @@ public:
     bool is_high();
     bool is_low();
 
+    // Register access for drivers that toggle the pin from an ISR
+    volatile uint8_t* port_register();
+    volatile uint8_t* pin_register();
+    uint8_t bit_mask();
+
 private:
-    PinType _pin_type; // Pin type (DIGITAL_PIN or ANALOG_PIN)
-    uint8_t _pin;      // Pin number (0-13 for digital, 0-5 for analog)
+    volatile uint8_t* _ddr;  // Data direction register
+    volatile uint8_t* _port; // Output / pull-up register
+    volatile uint8_t* _in;   // Input register (write 1 to toggle)
+    uint8_t _mask;           // Pin bit mask (0 for invalid pins)
 };
 
 #endif // GPIO_H
\ No newline at end of file
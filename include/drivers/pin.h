@@ -0,0 +1,181 @@
+#ifndef PIN_H
+#define PIN_H
+
+#include <avr/io.h>
+
+//==============================================================================
+// Port Addresses
+// Description: Data memory address of the PINx register of each port on the
+//              ATmega328p. DDRx and PORTx follow at +1 and +2. Constant
+//              addresses in the I/O range let the compiler emit single
+//              sbi/cbi/sbis/out instructions for the Pin methods below.
+//==============================================================================
+enum PinPort : uint8_t {
+    PIN_PORT_B = 0x23, // PINB, DDRB 0x24, PORTB 0x25
+    PIN_PORT_C = 0x26, // PINC, DDRC 0x27, PORTC 0x28
+    PIN_PORT_D = 0x29  // PIND, DDRD 0x2A, PORTD 0x2B
+};
+
+//==============================================================================
+// Pin Template Declaration
+// Description: Compile-time GPIO pin. Registers and mask are constants, so
+//              every method compiles to one or two instructions and the
+//              class holds no state. toggle() writes the bit to PINx, which
+//              flips only that output bit without a read-modify-write.
+//              Usage: Pin<PIN_PORT_B, 5>::toggle();
+//==============================================================================
+template <uint8_t port, uint8_t bit>
+struct Pin {
+    static_assert(port == PIN_PORT_B || port == PIN_PORT_C || port == PIN_PORT_D,
+                  "Invalid port, use PIN_PORT_B, PIN_PORT_C or PIN_PORT_D");
+    static_assert(bit < 8, "Invalid bit, must be 0-7");
+    static_assert(port != PIN_PORT_C || bit < 7, "PC7 does not exist");
+
+    static constexpr uint8_t port_addr = port;
+    static constexpr uint8_t mask = (1 << bit);
+
+    // Register access
+    static volatile uint8_t& pin_reg()  { return _SFR_MEM8(port); }
+    static volatile uint8_t& ddr_reg()  { return _SFR_MEM8(port + 1); }
+    static volatile uint8_t& port_reg() { return _SFR_MEM8(port + 2); }
+
+    // Configuration
+    static void enable_output()  { ddr_reg() |= mask; }
+    static void enable_input()   { ddr_reg() &= ~mask; }
+    static void enable_pullup()  { port_reg() |= mask; }
+    static void disable_pullup() { port_reg() &= ~mask; }
+
+    // Output
+    static void set_high() { port_reg() |= mask; }
+    static void set_low()  { port_reg() &= ~mask; }
+    static void toggle()   { pin_reg() = mask; }
+    static void write(bool high) { if (high) set_high(); else set_low(); }
+
+    // Input
+    static bool is_high() { return pin_reg() & mask; }
+    static bool is_low()  { return !(pin_reg() & mask); }
+};
+
+//==============================================================================
+// DigitalPin Template Declaration
+// Description: Pin by Arduino Uno pin number: 0-7 PORTD, 8-13 PORTB and
+//              14-19 (A0-A5) PORTC. Invalid pins fail to compile.
+//              Usage: DigitalPin<13>::set_high();
+//==============================================================================
+template <uint8_t n>
+struct DigitalPin : Pin<(n < 8 ? PIN_PORT_D : n < 14 ? PIN_PORT_B : PIN_PORT_C),
+                        (n < 8 ? n : n < 14 ? n - 8 : (n - 14) & 0x07)> {
+    static_assert(n <= 19, "Invalid pin, the Arduino Uno has pins 0-19");
+};
+
+//==============================================================================
+// PortGroup Template Declaration
+// Description: A set of compile-time pins written and read as one value,
+//              bit i of the value maps to the i-th pin. Each port is updated
+//              with a single write to PINx that toggles exactly the group
+//              bits that differ from the new value, so all pins of a port
+//              change in the same cycle and other pins (and ISRs driving
+//              them) are never disturbed, without disabling interrupts.
+//              Groups spanning ports split into one write per port (PORTB,
+//              then PORTC, then PORTD). Pins in a group must not be written
+//              from an ISR at the same time.
+//              Usage: using Bar = PortGroup<DigitalPin<2>, DigitalPin<3>, ..>;
+//                     Bar::enable_output(); Bar::write(0b0101);
+//==============================================================================
+// Number of set bits (PortGroup duplicate pin check)
+constexpr uint8_t pin_bit_count(uint8_t bits) {
+    return bits ? (bits & 1) + pin_bit_count(bits >> 1) : 0;
+}
+
+template <typename... Pins>
+struct PortGroup {
+    static_assert(sizeof...(Pins) > 0 && sizeof...(Pins) <= 16,
+                  "A PortGroup holds 1-16 pins");
+
+    static constexpr uint8_t size = sizeof...(Pins);
+    static constexpr uint16_t all = (uint16_t)((1UL << size) - 1);
+
+    // Spread value bits (bit i = i-th pin) to the bits of a port
+    static constexpr uint8_t port_bits(uint8_t port, uint16_t value) {
+        uint8_t bits = 0, i = 0;
+        ((bits |= (Pins::port_addr == port && ((value >> i) & 1)) 
+                  ? Pins::mask : 0, i++), ...);
+        return bits;
+    }
+
+    // Group bits on each port
+    static constexpr uint8_t mask_b =
+        ((Pins::port_addr == PIN_PORT_B ? Pins::mask : 0) | ...);
+    static constexpr uint8_t mask_c =
+        ((Pins::port_addr == PIN_PORT_C ? Pins::mask : 0) | ...);
+    static constexpr uint8_t mask_d =
+        ((Pins::port_addr == PIN_PORT_D ? Pins::mask : 0) | ...);
+
+    static_assert(pin_bit_count(mask_b) + pin_bit_count(mask_c) + 
+                  pin_bit_count(mask_d) == size,
+                  "A pin is used more than once in the PortGroup");
+
+    // Configuration
+    static void enable_output() {
+        _modify<PIN_PORT_B + 1, mask_b>(true);
+        _modify<PIN_PORT_C + 1, mask_c>(true);
+        _modify<PIN_PORT_D + 1, mask_d>(true);
+    }
+
+    static void enable_input() {
+        _modify<PIN_PORT_B + 1, mask_b>(false);
+        _modify<PIN_PORT_C + 1, mask_c>(false);
+        _modify<PIN_PORT_D + 1, mask_d>(false);
+    }
+
+    // Output
+    static void write(uint16_t value) { write_masked(value, all); }
+    static void set_high() { write_masked(all, all); }
+    static void set_low()  { write_masked(0, all); }
+
+    // Only the pins selected in select (bit i = i-th pin) are updated
+    static void write_masked(uint16_t value, uint16_t select) {
+        _write<PIN_PORT_B, mask_b>(port_bits(PIN_PORT_B, value),
+                                   port_bits(PIN_PORT_B, select));
+        _write<PIN_PORT_C, mask_c>(port_bits(PIN_PORT_C, value),
+                                   port_bits(PIN_PORT_C, select));
+        _write<PIN_PORT_D, mask_d>(port_bits(PIN_PORT_D, value),
+                                   port_bits(PIN_PORT_D, select));
+    }
+
+    static void toggle(uint16_t select = all) {
+        if (mask_b) _SFR_MEM8(PIN_PORT_B) = port_bits(PIN_PORT_B, select);
+        if (mask_c) _SFR_MEM8(PIN_PORT_C) = port_bits(PIN_PORT_C, select);
+        if (mask_d) _SFR_MEM8(PIN_PORT_D) = port_bits(PIN_PORT_D, select);
+    }
+
+    // Input (one read per port)
+    static uint16_t read() {
+        const uint8_t in_b = mask_b ? _SFR_MEM8(PIN_PORT_B) : 0;
+        const uint8_t in_c = mask_c ? _SFR_MEM8(PIN_PORT_C) : 0;
+        const uint8_t in_d = mask_d ? _SFR_MEM8(PIN_PORT_D) : 0;
+        uint16_t value = 0;
+        uint8_t i = 0;
+        ((value |= ((Pins::port_addr == PIN_PORT_B ? in_b :
+                     Pins::port_addr == PIN_PORT_C ? in_c : in_d) & Pins::mask)
+                   ? (uint16_t)(1 << i) : 0, i++), ...);
+        return value;
+    }
+
+private:
+    // Toggle the selected bits that differ from bits in one PINx write
+    template <uint8_t port, uint8_t group_mask>
+    static void _write(uint8_t bits, uint8_t select) {
+        if (group_mask == 0) return; // Port not in the group
+        _SFR_MEM8(port) = (_SFR_MEM8(port + 2) ^ bits) & select;
+    }
+
+    template <uint8_t reg, uint8_t group_mask>
+    static void _modify(bool set) {
+        if (group_mask == 0) return;
+        if (set) _SFR_MEM8(reg) |= group_mask;
+        else     _SFR_MEM8(reg) &= ~group_mask;
+    }
+};
+
+#endif // PIN_H
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <avr/io.h>
+#include "drivers/clock.h"
+
+//==============================================================================
+// Power Class Declaration
+// Description: Idle handling for the main loop. The CPU sleeps in IDLE mode
+//              until the next interrupt (at the latest the 1ms SystemClock
+//              tick), and the time spent asleep is measured over fixed
+//              windows to report the CPU load.
+//==============================================================================
+class Power {
+public:
+    static constexpr uint16_t LOAD_WINDOW_MS = 1000; // Load measurement window
+
+    // CPU load over the last complete window
+    struct LoadStats {
+        uint16_t load;    // Active time (0.1%)
+        uint16_t wakeups; // Wakeups from sleep
+        uint16_t window;  // Window length (ms)
+    };
+
+    // Public methods
+    static void init();
+    static void idle(bool (*busy)() = nullptr);
+    static void load_stats(LoadStats &stats);
+
+private:
+    static uint32_t _window_start; // SystemClock::micros() at window start
+    static uint32_t _sleep_us;     // Time asleep in the current window
+    static uint16_t _wakeups;      // Wakeups in the current window
+    static LoadStats _last;        // Last complete window
+};
+
+#endif // POWER_H
\ No newline at end of file
@@ -2,7 +2,7 @@
 #define PWM_H
 
 #include <avr/io.h>
-#include "drivers/timer.h"
+#include "drivers/clock.h"
 
 //==============================================================================
 // PWM Class Declaration
@@ -14,7 +14,11 @@ public:
     bool init();
     void reset();
     void set_duty_cycle(uint8_t duty);
-    void ramp_output(const uint16_t &cycle_time, Timer &timer);
+    void ramp_output(const uint16_t &cycle_time);
+    void stop_ramp();
+
+    // Ramp tick handler (called from the SystemClock tick ISR)
+    static void handle_ramp_tick();
 
 protected:
     uint8_t _duty_cycle;
@@ -23,11 +27,15 @@ private:
     uint8_t _pin;
     volatile uint16_t* _ocr16; // 16-bit output compare register (timer 1)
     volatile uint8_t* _ocr8;   // 8-bit output compare register (timer 0, 2)
+    volatile uint8_t* _tccr;   // TCCRnA holding the output mode bits (init)
+    uint8_t _com_mask;         // COMnx1 bit connecting the pin
+
+    // Variables for ramp method (advanced by the tick ISR)
+    uint16_t _cycle_time;     // Ramp cycle time (ms) of _phase_step
+    uint32_t _phase;          // Ramp position (full cycle = 2^32)
+    uint32_t _phase_step;     // Phase increment per 1ms tick
 
-    // Variables for ramp method
-    unsigned long _overflow_counter;
-    unsigned long _last_overflow_count;
-    bool _ramp_up;
+    static PWModulation* volatile _ramp_pwm; // Output driven by the ramp
 
     // Validation methods (compile-time checks)
     static constexpr bool _valid_pwm_pin(uint8_t _pin);
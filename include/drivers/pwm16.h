@@ -0,0 +1,96 @@
+#ifndef PWM16_H
+#define PWM16_H
+
+#include <avr/io.h>
+#include "drivers/timer.h"
+
+//==============================================================================
+// PWM16 Class Declaration
+// Description: Timer 1 PWM on pins 9 (OC1A) and 10 (OC1B) with ICR1 as TOP,
+//              so resolution (2-16 bits) and frequency are selectable. Duty
+//              and TOP changes are staged, then committed together and
+//              latched by the overflow interrupt, so both channels change in
+//              the same PWM period without glitches.
+//==============================================================================
+class PWM16 {
+public:
+    enum Mode {
+        FAST,               // Single slope, highest frequency for a TOP
+        PHASE_CORRECT,      // Dual slope, symmetric pulses
+        PHASE_FREQ_CORRECT  // Dual slope, glitch-free TOP (frequency) changes
+    };
+    enum Channel { CH_A, CH_B };
+
+    // Output masks for init()
+    static constexpr uint8_t OUTPUT_A = (1 << CH_A); // Pin 9
+    static constexpr uint8_t OUTPUT_B = (1 << CH_B); // Pin 10
+    static constexpr uint16_t MIN_TOP = 3;           // 2-bit resolution
+
+    // Register settings for a frequency or resolution
+    struct Settings {
+        uint16_t prescaler; // Clock prescaler (0 if invalid)
+        uint16_t top;       // ICR1 value, duty range is 0-top
+    };
+
+    // Public methods
+    static bool init(Mode mode, const Settings &settings, uint8_t outputs);
+    static void stop();
+    static void set_duty(Channel ch, uint16_t duty);
+    static void set_top(uint16_t top);
+    static void commit();
+    static bool pending();
+    static uint16_t top();
+
+    // Overflow interrupt handler (attached to TIMER1_OVF_vect)
+    static void handle_overflow();
+
+    //==========================================================================
+    // Static Methods: solve, from_bits, freq_hz
+    // Description: solve() picks the smallest prescaler (and so the largest
+    //              TOP, the finest resolution) for a PWM frequency. Dual
+    //              slope modes count up and down, so they need half the TOP
+    //              of fast PWM for the same frequency. from_bits() selects
+    //              the resolution instead, freq_hz() reports the result.
+    //==========================================================================
+    static constexpr Settings solve(Mode mode, uint32_t freq_hz) {
+        const uint16_t prescalers[] = { 1, 8, 64, 256, 1024 };
+        const uint32_t slopes = (mode == FAST) ? 1 : 2;
+
+        if (freq_hz == 0) return { 0, 0 };
+
+        for (uint16_t prescaler : prescalers) {
+            // Counts per period would be 0 long before the product overflows
+            if (freq_hz > UINT32_MAX / (slopes * prescaler)) break;
+            uint32_t counts = fixed::div_round(F_CPU, freq_hz * slopes * prescaler);
+            uint32_t top = (mode == FAST) ? counts - 1 : counts;
+            if (counts == 0 || top < MIN_TOP) break; // Too fast for any prescaler
+            if (top <= UINT16_MAX) return { prescaler, (uint16_t)top };
+        }
+        return { 0, 0 };
+    }
+
+    static constexpr Settings from_bits(uint8_t bits, uint16_t prescaler = 1) {
+        return (bits < 2 || bits > 16) ? Settings{ 0, 0 } 
+                                       : Settings{ prescaler, 
+                                                   (uint16_t)((1UL << bits) - 1) };
+    }
+
+    static constexpr uint32_t freq_hz(Mode mode, const Settings &settings) {
+        return settings.prescaler == 0 ? 0 :
+               (mode == FAST) ? F_CPU / settings.prescaler / (settings.top + 1UL)
+                              : F_CPU / settings.prescaler / (2UL * settings.top);
+    }
+
+private:
+    static Mode _mode;
+    static uint8_t _outputs;                 // Enabled outputs (OUTPUT_A/B)
+    static uint16_t _staged_duty[2];         // Set by set_duty()
+    static uint16_t _staged_top;             // Set by set_top()
+    static volatile uint16_t _latch_duty[2]; // Committed, written by the ISR
+    static volatile uint16_t _latch_top;
+    static volatile bool _pending;           // Commit waiting for an overflow
+    static volatile uint8_t _com;            // COM1x1 bits of the last commit
+    static volatile bool _com_pending;       // Disconnect waiting for an overflow
+};
+
+#endif // PWM16_H
\ No newline at end of file
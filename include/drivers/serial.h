@@ -2,6 +2,8 @@
 #define SERIAL_H
 
 #include <avr/io.h>
+#include <avr/pgmspace.h>
+#include "drivers/gpio.h"
 
 //======================================================================
 // Serial Configuration Macros
@@ -11,9 +13,9 @@
 #define F_CPU 16000000UL // Define MCU clock speed if not defined
 #endif
 
-// Enable UART with specific baud rate and data bits
-#define ENABLE_UART(baudRate, dataBits) do { \
-    SET_UART_BAUD_RATE(baudRate); \
+// Enable UART with specific baud rate register value and data bits
+#define ENABLE_UART(ubrr, u2x, dataBits) do { \
+    SET_UART_BAUD_RATE(ubrr, u2x); \
     ENABLE_UART_TX(); \
     ENABLE_UART_RX(); \
     SET_UART_DATA_BITS(dataBits); \
@@ -38,13 +40,20 @@
 #define DISABLE_UART_TX() (UCSR0B &= ~(1 << TXEN0))
 #define DISABLE_UART_RX() (UCSR0B &= ~(1 << RXEN0))
 
-// Macro to calculate UBRR (Baud rate register) for given baud rate
-#define UBRR_VALUE(baudRate) ((F_CPU / 16 / (baudRate)) - 1)
+// Macro to calculate UBRR (Baud rate register) for given baud rate, rounded
+// to nearest. Divisor is 16 in normal mode and 8 in double speed (U2X0) mode.
+#define UBRR_VALUE(baudRate, divisor) \
+    (((F_CPU) + (divisor) / 2 * (baudRate)) / ((divisor) * (baudRate)) - 1)
 
-// Set UART baud rate (e.g., 9600, 19200, 38400, 57600, 115200, etc.)
-#define SET_UART_BAUD_RATE(baudRate) do { \
-    UBRR0H = (UBRR_VALUE(baudRate) >> 8); \
-    UBRR0L =  UBRR_VALUE(baudRate); \
+// Macro to calculate the actual baud rate for given UBRR and divisor
+#define UBRR_BAUD_RATE(ubrr, divisor) ((F_CPU) / ((divisor) * ((ubrr) + 1UL)))
+
+// Set UART baud rate register and double speed (U2X0) mode
+#define SET_UART_BAUD_RATE(ubrr, u2x) do { \
+    UBRR0H = ((ubrr) >> 8); \
+    UBRR0L =  (ubrr); \
+    if (u2x) UCSR0A |= (1 << U2X0); \
+    else UCSR0A &= ~(1 << U2X0); \
 } while (0)
 
 // Set UART data bits (5, 6, 7, 8, or 9 bits)
@@ -63,41 +72,271 @@
 // Enable UART Interrupts
 #define ENABLE_UART_RX_INTERRUPT() (UCSR0B |= (1 << RXCIE0))
 
+// Enable/disable the data register empty interrupt (drains the TX buffer)
+#define ENABLE_UART_UDRE_INTERRUPT()  (UCSR0B |=  (1 << UDRIE0))
+#define DISABLE_UART_UDRE_INTERRUPT() (UCSR0B &= ~(1 << UDRIE0))
+
+//==============================================================================
+// UartBaud Template Declaration
+// Description: Computes UBRR for a baud rate at compile time. Double speed
+//              (U2X0) mode is chosen when it gives a smaller error, and
+//              configurations outside the error tolerance fail to compile.
+//==============================================================================
+template <uint32_t baud_rate>
+struct UartBaud {
+    static constexpr int32_t max_error = 21; // Max baud error in 0.1% (±2.1%)
+
+    static constexpr uint32_t ubrr_16x = UBRR_VALUE(baud_rate, 16UL);
+    static constexpr uint32_t ubrr_8x  = UBRR_VALUE(baud_rate, 8UL);
+
+    // Baud rate error (in 0.1%) of the given UBRR and divisor
+    static constexpr int32_t error_of(uint32_t ubrr, uint32_t divisor) {
+        return ((int32_t)UBRR_BAUD_RATE(ubrr, divisor) - (int32_t)baud_rate) *
+               1000 / (int32_t)baud_rate;
+    }
+
+    static constexpr int32_t abs_error(int32_t error) {
+        return error < 0 ? -error : error;
+    }
+
+    static constexpr bool u2x = abs_error(error_of(ubrr_8x, 8)) <
+                                abs_error(error_of(ubrr_16x, 16));
+    static constexpr uint16_t ubrr = u2x ? ubrr_8x : ubrr_16x;
+    static constexpr int32_t error = u2x ? error_of(ubrr_8x, 8) :
+                                           error_of(ubrr_16x, 16);
+
+    static_assert(baud_rate > 0 && baud_rate <= F_CPU / 8,
+                  "Baud rate is out of range for F_CPU");
+    static_assert((u2x ? ubrr_8x : ubrr_16x) <= 4095,
+                  "Baud rate is too low for the 12-bit UBRR register");
+    static_assert(abs_error(error) <= max_error,
+                  "Baud rate error exceeds tolerance, choose another baud rate");
+};
+
 //==============================================================================
-// Serial Class Declaration
+// SerialPort Class Template Declaration
+// Description: UART driver with RX/TX circular buffers. The buffer sizes are
+//              template parameters and must be powers of two, so index
+//              wrap-around is a single mask operation. The firmware uses
+//              the Serial alias below, sized by SERIAL_RX_BUF_SIZE and
+//              SERIAL_TX_BUF_SIZE (set in CMakeLists.txt).
 //==============================================================================
-class Serial {
+template <uint8_t rx_size, uint8_t tx_size>
+class SerialPort {
 public:
-    static constexpr uint8_t buf_size = 64; // Buffer size for UART communication
+    // Policy applied by uart_put_char/uart_put_str when the TX buffer is full
+    enum TxPolicy { TX_BLOCK, TX_DROP, TX_OVERWRITE };
+
+    // Flow control. RTS (output) and CTS (input) are active low GPIO pins.
+    enum FlowControl { FLOW_NONE, FLOW_XONXOFF, FLOW_RTSCTS };
+    static constexpr char XON  = 0x11;
+    static constexpr char XOFF = 0x13;
+
+    static constexpr uint8_t buf_size = rx_size;    // Buffer size for UART communication
+    static constexpr uint8_t tx_buf_size = tx_size; // Buffer size for UART transmit
+    static constexpr uint8_t line_queue_size = 4;   // Max complete lines pending
+    static constexpr uint8_t frame_max = 16;        // Max decoded frame size
+    static constexpr uint8_t frame_encoded_max =    // COBS adds a byte per 254
+        frame_max + 1 + frame_max / 254;
+
+    // Index masks for the circular buffers (sizes are powers of two)
+    static constexpr uint8_t rx_mask = rx_size - 1;
+    static constexpr uint8_t tx_mask = tx_size - 1;
+    static constexpr uint8_t line_mask = line_queue_size - 1;
+
+    static_assert(rx_size >= 8 && (rx_size & rx_mask) == 0,
+                  "RX buffer size must be a power of two (8-128)");
+    static_assert(tx_size >= 8 && (tx_size & tx_mask) == 0,
+                  "TX buffer size must be a power of two (8-128)");
+    static_assert((line_queue_size & line_mask) == 0,
+                  "Line queue size must be a power of two");
+
+    // RX buffer fill levels that pause and resume the sender. With flow
+    // control a line must stay below rx_high_water, longer lines overflow
+    static constexpr uint8_t rx_high_water = rx_size - rx_size / 4;
+    static constexpr uint8_t rx_low_water  = rx_size / 4;
+
+    // Descriptor for a complete line (or binary frame) in the RX buffer
+    struct LineDesc {
+        uint8_t start;
+        uint8_t length;
+        bool overflow;
+        bool frame;
+    };
+
+    // Snapshot of the UART line error counters
+    struct LineStats {
+        uint16_t framing_errors; // Stop bit not found (FE0)
+        uint16_t overrun_errors; // Byte lost in the UART (DOR0)
+        uint16_t parity_errors;  // Parity check failed (UPE0)
+        uint16_t ring_overflows; // Line dropped, RX buffer or queue full
+        uint16_t frame_errors;   // Invalid binary frames
+    };
+
+    //==========================================================================
+    // LineView Class Declaration
+    // Description: Read-only view of a received line that still lives in the
+    //              RX circular buffer. Valid until the line is released.
+    //==========================================================================
+    class LineView {
+    public:
+        LineView() : _start(0), _length(0), _overflow(false), _frame(false) {}
+        LineView(uint8_t start, uint8_t length, bool overflow, bool frame)
+            : _start(start), _length(length), _overflow(overflow),
+              _frame(frame) {}
+
+        uint8_t length() const { return _length; }
+        bool overflowed() const { return _overflow; }
+        bool is_frame() const { return _frame; }
+        char operator[](uint8_t index) const {
+            return uart_buffer[(uint8_t)(_start + index) & rx_mask];
+        }
+
+    private:
+        uint8_t _start;  // Position of the first character in the RX buffer
+        uint8_t _length; // Number of characters (excluding the delimiter)
+        bool _overflow;  // Line did not fit in the RX buffer and was discarded
+        bool _frame;     // Binary COBS frame instead of a text line
+    };
 
     // Circular buffer for UART communication
     static volatile char uart_buffer[buf_size];
-    static volatile uint8_t uart_next_pos;
     static volatile uint8_t uart_read_pos;
     static volatile uint8_t uart_write_pos;
-    static volatile bool uart_command_ready;
     static volatile bool uart_buffer_overflow;
 
+    // Queue of complete lines in the RX buffer (filled by USART_RX_vect)
+    static volatile LineDesc uart_lines[line_queue_size];
+    static volatile uint8_t uart_line_head;  // Next descriptor to consume
+    static volatile uint8_t uart_line_tail;  // Next descriptor to fill
+    static volatile uint8_t uart_line_count; // Number of pending lines
+    static volatile uint8_t uart_line_start; // Start of the line being received
+    static uint8_t uart_line_cursor;         // uart_get_char position in line
+    static volatile bool uart_rx_frame;      // Receiving a binary frame
+    static volatile uint16_t uart_frame_errors; // Invalid binary frames received
+
+    // Circular buffer for UART transmit (drained by USART_UDRE_vect)
+    static volatile char uart_tx_buffer[tx_buf_size];
+    static volatile uint8_t uart_tx_read_pos;
+    static volatile uint8_t uart_tx_write_pos;
+    static volatile uint16_t uart_tx_dropped;
+
+    // Flow control state
+    static volatile uint8_t uart_flow;           // FlowControl mode
+    static volatile bool uart_rx_throttled;      // Sender asked to pause
+    static volatile bool uart_tx_paused;         // XOFF received from host
+    static volatile char uart_flow_char;         // XON/XOFF to send (0: none)
+    static volatile uint8_t* uart_rts_port;      // RTS output register
+    static volatile uint8_t* uart_cts_pin;       // CTS input register
+    static uint8_t uart_rts_mask;
+    static uint8_t uart_cts_mask;
+
+    // Line error counters (updated by USART_RX_vect)
+    static volatile uint16_t uart_framing_errors;
+    static volatile uint16_t uart_overrun_errors;
+    static volatile uint16_t uart_parity_errors;
+    static volatile uint16_t uart_ring_overflows;
+
     // Constructor
-    Serial();
+    SerialPort();
 
-    // Public init method
-    void uart_init(const uint32_t& baud_rate, const uint8_t& data_bits);
+    // Public init method (baud rate is validated at compile time)
+    template <uint32_t baud_rate>
+    void uart_init(const uint8_t& data_bits) {
+        _uart_init(UartBaud<baud_rate>::ubrr, UartBaud<baud_rate>::u2x,
+                   baud_rate, data_bits);
+    }
 
     // Public UART methods
     void uart_put_char(unsigned char data);
     void uart_put_str(const char* str);
+    void uart_put_str_P(const char* str);
+    void uart_printf_P(const char* format, ...);
+    bool uart_put_char_nb(unsigned char data);
+    uint8_t uart_put_str_nb(const char* str);
+    void uart_flush();
+    void set_tx_policy(TxPolicy policy);
+    bool set_flow_control(FlowControl mode, uint8_t rts_pin = 0, 
+                          uint8_t cts_pin = 0);
+    void uart_line_stats(LineStats& stats);
+    void note_frame_error();
+    void uart_put_line(const LineView& line);
     bool uart_get_char(char* character);
-    void uart_rec_str(char* buffer, const uint8_t& buf_size);
     void uart_echo();
 
+    // Copies the oldest pending line into buffer (checked at compile time)
+    template <uint8_t size>
+    void uart_rec_str(char (&buffer)[size]) {
+        static_assert(size >= buf_size, "Specified buffer size is too small!");
+        _rec_str(buffer, size);
+    }
+
+    // Public line queue methods (zero-copy access to received lines)
+    uint8_t uart_lines_pending();
+    static bool uart_line_queued(); // For Power::idle(), no init check
+    bool uart_peek_line(LineView& line);
+    void uart_release_line();
+
+    // Public binary frame methods (COBS + CRC-16/XMODEM, see serial.cpp)
+    uint8_t uart_read_frame(const LineView& line, uint8_t* data, uint8_t size);
+    void uart_put_frame(const uint8_t* data, uint8_t length);
+
+    // Interrupt handlers (inlined into USART_RX_vect and USART_UDRE_vect, so
+    // the ISRs make no calls and only save the registers they use)
+    __attribute__((always_inline)) static inline void handle_rx_interrupt();
+    __attribute__((always_inline)) static inline void handle_udre_interrupt();
+    static void handle_cts_interrupt();
+
 private:
-    bool initialized; // Flag to check if UART is initialized
+    bool initialized;    // Flag to check if UART is initialized
+    TxPolicy _tx_policy; // What to do when the TX buffer is full
+
+    // Private init method
+    void _uart_init(uint16_t ubrr, bool u2x, uint32_t baud_rate, 
+                    uint8_t data_bits);
+
+    // Private RX helpers
+    void _rec_str(char* buffer, uint8_t size);
+
+    // Private TX buffer helpers
+    bool _tx_enqueue(unsigned char data);
+    void _tx_overwrite(unsigned char data);
+    void _tx_poll();
+
+    // Private flow control helpers
+    __attribute__((always_inline)) static inline void _set_rx_throttle(bool throttle);
+
+    // Private formatting helpers
+    void _put_uint(uint32_t value);
+
+    // Private frame helpers
+    static uint16_t _crc16(const uint8_t* data, uint8_t length);
 
     // Private constexpr methods (compile-time validations)
-    static constexpr bool valid_baud(const uint32_t baud_rate);
     static constexpr bool valid_bits(const uint8_t data_bits);
-    static constexpr uint8_t valid_buf_size();
 };
 
+//==============================================================================
+// Serial Configuration
+// Description: The UART instance used by the firmware. Buffer sizes trade
+//              RAM for burst tolerance and can be set per build.
+//==============================================================================
+#ifndef SERIAL_RX_BUF_SIZE
+#define SERIAL_RX_BUF_SIZE 64  // Define default RX buffer size if not defined
+#endif
+
+#ifndef SERIAL_TX_BUF_SIZE
+#define SERIAL_TX_BUF_SIZE 128 // Define default TX buffer size if not defined
+#endif
+
+// RTS/CTS flow control needs the PCINT0 and PCINT2 vectors for the CTS pin,
+// so they are only defined by the driver (and FLOW_RTSCTS only accepted)
+// when this is set, leaving them free for other pin change users otherwise
+#ifndef SERIAL_FLOW_RTSCTS
+#define SERIAL_FLOW_RTSCTS 0
+#endif
+
+using Serial = SerialPort<SERIAL_RX_BUF_SIZE, SERIAL_TX_BUF_SIZE>;
+using LineView = Serial::LineView;
+
 #endif // SERIAL_H
\ No newline at end of file
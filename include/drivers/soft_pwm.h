@@ -0,0 +1,134 @@
+#ifndef SOFT_PWM_H
+#define SOFT_PWM_H
+
+#include <avr/io.h>
+#include "drivers/timer.h"
+
+//==============================================================================
+// SoftPWM Class Declaration
+// Description: 8-bit software PWM on any GPIO using bit-angle modulation.
+//              Each PWM period is split into 8 slots of 1, 2, .. 128 base
+//              ticks and slot k outputs bit k of every duty cycle, so there
+//              are only 8 interrupts per period whatever the channel count.
+//              The outputs are precomputed per port (bit planes), and the
+//              ISR writes each port once. Timer 1 (CTC) times the slots,
+//              TIMER1_COMPA_vect jumps to a call-free handler running
+//              handle_compare() while the GPIOR0 RUNNING_BIT is set.
+//
+//              Usage: SoftPWM::add(0, 2); SoftPWM::add(1, 13); SoftPWM::init();
+//                     SoftPWM::set_duty(0, 40); SoftPWM::commit();
+//==============================================================================
+class SoftPWM {
+public:
+    static constexpr uint8_t  MAX_CHANNELS = 20; // One per Uno GPIO
+    static constexpr uint8_t  MAX_PIN      = 19; // A0-A5 are pins 14-19
+    static constexpr uint8_t  BITS         = 8;  // Duty resolution
+    static constexpr uint8_t  PORTS        = 3;  // B, C, D
+    static constexpr uint16_t PRESCALER    = 8;  // Timer 1 clock (0.5us)
+    static constexpr uint16_t BASE_COUNTS  = 64; // Shortest slot (32us)
+    static constexpr uint32_t REFRESH_HZ   = 
+        F_CPU / PRESCALER / (BASE_COUNTS * ((1UL << BITS) - 1));
+    static constexpr uint8_t  RUNNING_BIT  = 0;  // GPIOR0 flag for the ISR
+
+    // CPU cycles from a compare match to the OCR1A write in the worst case:
+    // the longest driver ISR plus the dispatch and entry of this one (~35).
+    // The timer 0 tick running the PWM ramp and an oversampling ADCScanner
+    // step each take ~300 cycles with their callee register saves, the UART
+    // RX ISR ~250. Application callbacks (ADConverter, timer 2 hooks) are
+    // not included and must stay short. Slot 0 must outlast this, or every
+    // frame would take the late path in handle_compare(), see late_count().
+    static constexpr uint16_t MAX_LATENCY = 340;
+    static_assert((uint32_t)BASE_COUNTS * PRESCALER > MAX_LATENCY,
+                  "Slot 0 is shorter than the compare ISR latency");
+
+    static_assert(((uint32_t)BASE_COUNTS << (BITS - 1)) <= 65536UL,
+                  "Longest bit-angle slot does not fit timer 1");
+    static_assert(TIMER1_PS_BITS(PRESCALER) != 0, "Invalid timer 1 prescaler");
+
+    // Public methods
+    static bool init();
+    static void stop();
+    static bool add(uint8_t channel, uint8_t pin);
+    static void remove(uint8_t channel);
+    static void set_duty(uint8_t channel, uint8_t duty);
+    static uint8_t duty(uint8_t channel);
+    static void commit();
+    static uint16_t late_count();
+    static bool is_running() { return GPIOR0 & (1 << RUNNING_BIT); }
+
+    // Compare match handler (inlined into TIMER1_COMPA_vect)
+    __attribute__((always_inline)) static inline void handle_compare();
+
+private:
+    static constexpr uint8_t NO_PORT = 0xFF;
+
+    static uint8_t _port[MAX_CHANNELS];           // Port index (NO_PORT if unused)
+    static uint8_t _mask[MAX_CHANNELS];           // Pin bit mask
+    static uint8_t _duty[MAX_CHANNELS];           // Staged duty cycles
+    static volatile uint8_t _port_mask[PORTS];    // Pins driven per port
+    static uint8_t _planes[2][BITS][PORTS];       // Port outputs per slot
+    static volatile uint8_t _front;               // Buffer read by the ISR
+    static volatile bool _swap;                   // Swap at the next period
+    static uint8_t _bit;                          // Slot output by the ISR
+    static uint8_t _next_out[PORTS];              // Port values of the next slot
+    static uint16_t _next_ocr;                    // OCR1A of the next slot
+    static volatile uint16_t _late_slots;         // Slots started too late
+
+    __attribute__((always_inline)) static inline void _prepare_next();
+};
+
+//==============================================================================
+// Static Method: handle_compare
+// Description: Start the slot prepared by the previous interrupt. Its length
+//              is written first: the compare match has cleared the counter,
+//              so the new OCR1A applies to this slot. Slot 0 (512 CPU
+//              cycles) outlasts MAX_LATENCY, so late_count() stays at 0 at
+//              the default settings. If a longer interrupt still delayed
+//              this one until TCNT1 passed the new TOP, the counter is
+//              restarted (the slot runs long once) instead of wrapping
+//              through 0xFFFF. Defined here so the ISR inlines it. The ports
+//              are written through PINx (toggle on 1), so the ISR never
+//              changes other pins of the port. A main loop read-modify-write
+//              of the same port (e.g. GPIO::set_high through a pointer) that
+//              this ISR interrupts still writes back the old SoftPWM bits
+//              and loses the slot until the next one, so such writes must
+//              be made in an ATOMIC_BLOCK or as PINx toggles. The next slot
+//              is prepared after the outputs are written.
+//==============================================================================
+inline void SoftPWM::handle_compare() {
+    uint16_t ocr = _next_ocr;
+    OCR1A = ocr;
+    if (TCNT1 >= ocr) {
+        TCNT1 = 0;
+        _late_slots++;
+    }
+
+    PINB = (PORTB ^ _next_out[0]) & _port_mask[0];
+    PINC = (PORTC ^ _next_out[1]) & _port_mask[1];
+    PIND = (PORTD ^ _next_out[2]) & _port_mask[2];
+
+    _prepare_next();
+}
+
+//==============================================================================
+// Private Method: _prepare_next
+// Description: Move to the next slot and copy its port values and length, so
+//              handle_compare() has nothing to compute before the writes. A
+//              committed back buffer is swapped in before slot 0.
+//==============================================================================
+inline void SoftPWM::_prepare_next() {
+    uint8_t bit = (_bit + 1) & (BITS - 1);
+    _bit = bit;
+    if (bit == 0 && _swap) {
+        _front ^= 1;
+        _swap = false;
+    }
+
+    const uint8_t* out = _planes[_front][bit];
+    _next_out[0] = out[0];
+    _next_out[1] = out[1];
+    _next_out[2] = out[2];
+    _next_ocr = (BASE_COUNTS << bit) - 1;
+}
+
+#endif // SOFT_PWM_H
\ No newline at end of file
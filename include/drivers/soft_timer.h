@@ -0,0 +1,73 @@
+#ifndef SOFT_TIMER_H
+#define SOFT_TIMER_H
+
+#include <avr/io.h>
+#include "drivers/clock.h"
+
+//==============================================================================
+// SoftTimer Class Declaration
+// Description: One-shot or periodic virtual timer on the SystemClock ms tick.
+//              Timers are intrusive list nodes owned by the caller, so starting
+//              and stopping is O(1) and needs no allocation. Expiry sets a
+//              flag (see expired()) and optionally runs a callback, both from
+//              TimerWheel::poll() in the main loop, never from an ISR.
+//==============================================================================
+class SoftTimer {
+friend class TimerWheel;
+public:
+    typedef void (*Callback)(void* context);
+
+    // Constructor / Destructor
+    SoftTimer(Callback callback = nullptr, void* context = nullptr);
+    ~SoftTimer();
+
+    // Public Methods
+    void start(uint32_t delay, uint32_t period = 0);
+    void start_periodic(uint32_t period) { start(period, period); }
+    void stop();
+    void set_period(uint32_t period) { _period = period; }
+    uint32_t period() const { return _period; }
+    bool is_active() const { return _active; }
+    bool expired(); // Returns true once per expiry (clears the flag)
+
+private:
+    SoftTimer* _next;   // Next timer in the wheel slot
+    SoftTimer* _prev;   // Previous timer in the wheel slot
+    uint32_t _expires;  // SystemClock::millis() at expiry
+    uint32_t _period;   // Reload period (0 for one-shot)
+    Callback _callback;
+    void*    _context;
+    bool     _active;
+    bool     _fired;
+};
+
+//==============================================================================
+// TimerWheel Class Declaration
+// Description: Hashed timer wheel holding all active SoftTimers. A timer is
+//              stored in slot (expiry & slot_mask), so insert and remove are
+//              O(1) and each ms tick only scans one slot. Timers further
+//              than one revolution away stay in their slot until expired.
+//==============================================================================
+class TimerWheel {
+public:
+    static constexpr uint8_t slots = 16; // Wheel size (power of two)
+    static constexpr uint8_t slot_mask = slots - 1;
+    static_assert((slots & slot_mask) == 0, "Wheel size must be a power of two");
+
+    // Public Methods
+    static void poll(); // Advance the wheel to millis(), call in the main loop
+    static bool pending();  // True if a timer may be due (tick not polled)
+    static uint8_t active_count() { return _active; }
+
+private:
+    friend class SoftTimer;
+    static void _insert(SoftTimer* timer);
+    static void _remove(SoftTimer* timer);
+    static void _expire(SoftTimer* timer, uint32_t now);
+
+    static SoftTimer* _slots[slots];
+    static uint32_t _last_tick; // Last processed millis() tick
+    static uint8_t _active;     // Number of active timers
+};
+
+#endif // SOFT_TIMER_H
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <stddef.h>         // size_t
-#include <stdio.h>          // For sprintf 
+#include "fixed_point.h"
 #include "drivers/serial.h"
 
 #ifndef F_CPU
@@ -37,6 +37,24 @@
     (prescaler)  == 1024 ? ((1 << CS22) | (1 << CS21) | (1 << CS20)) : \
     0)
 
+//==============================================================================
+// Compare ISR hooks (selected at link time)
+// Description: Define any of these functions in the application and the
+//              compare match ISR calls it directly, without a function
+//              pointer. compare hooks run on every compare match, interval
+//              hooks once per configured interval (after the soft divisor).
+//              timer0_compare_hook runs on the 1ms SystemClock tick. The
+//              hooks are for the application only, no driver defines them.
+//              While SoftPWM owns timer 1 its slots take the whole compare
+//              ISR and the timer 1 hooks are not called. Keep them short,
+//              they run with interrupts disabled.
+//==============================================================================
+void timer0_compare_hook() __attribute__((weak));
+void timer1_compare_hook() __attribute__((weak));
+void timer1_interval_hook() __attribute__((weak));
+void timer2_compare_hook() __attribute__((weak));
+void timer2_interval_hook() __attribute__((weak));
+
 //==============================================================================
 // Timer Class Declaration
 //==============================================================================
@@ -44,18 +62,37 @@ class Timer {
 public:
     enum TimerNum  { TIMER0, TIMER1, TIMER2 };
     enum TimeUnit  { MILLIS, MICROS };
-    enum TimerMode { NORMAL, CTC, EXT_CLOCK };
+    enum TimerMode { NORMAL, CTC, EXT_CLOCK, CAPTURE };
+
+    // Compare ISR callback (registered at run time, see attach())
+    typedef void (*Callback)();
+
+    // Register settings for an interval, see solve()
+    struct TimerSettings {
+        uint32_t interval;  // Requested interval (ms or us)
+        uint16_t prescaler; // Clock prescaler (0 if the interval is invalid)
+        uint16_t ocr;       // Output compare value (counts - 1)
+        uint16_t divisor;   // Compare matches per interval (software divisor)
+        int32_t  error_ppm; // Achieved period error (parts per million)
+    };
 
-    struct PrescalerSettings {
-        uint32_t threshold;
-        uint16_t prescaler;
+    // Signal measurement from the input capture edges, see measure()
+    struct CaptureResult {
+        uint32_t period_ns; // Average period (ns)
+        uint32_t high_ns;   // Average high time (ns)
+        uint32_t freq_chz;  // Frequency (0.01 Hz)
+        uint16_t duty;      // Duty cycle (0.1%)
+        uint8_t  periods;   // Number of periods averaged
     };
 
     // constexpr variables
-    static constexpr uint32_t US_PER_SEC        = 1000000UL; // microseconds per second
-    static constexpr double   MS_PER_SEC        = 1000.0;    // milliseconds per second
-    static constexpr uint16_t MAX_INTERVAL      = 4000;      // Maximum interval for 16-bit timers (ms)
-    static constexpr uint8_t  MAX_INTERVAL_8BIT = 255;       // Maximum interval for 8-bit timers
+    static constexpr uint32_t US_PER_SEC = 1000000UL; // microseconds per second
+    static constexpr uint32_t MS_PER_SEC = 1000UL;    // milliseconds per second
+    static constexpr uint32_t MIN_ISR_CYCLES = 4096;  // Min cycles between ISRs (divisor > 1)
+    static constexpr uint8_t CAPTURE_SIZE = 8;        // Captured edges (max 8)
+    static constexpr uint8_t CAPTURE_MASK = CAPTURE_SIZE - 1;
+    static_assert((CAPTURE_SIZE & CAPTURE_MASK) == 0 && CAPTURE_SIZE <= 8,
+                  "CAPTURE_SIZE must be a power of two of at most 8");
 
     // Static Singleton Instances
     static Timer timer_0;
@@ -65,8 +102,16 @@ public:
     // Public methods
     static Timer* get_instance(TimerNum num); // Get the Singleton instance
     void configure(TimerMode mode, uint32_t interval, Serial &serial);
+    void configure(TimerMode mode, const TimerSettings &settings, Serial &serial);
     void start();
     void stop();
+    bool start_capture(bool noise_canceler = true); // Timer 1 only (ICP1)
+    void stop_capture();
+    void release();
+    bool measure(CaptureResult &result);
+    void attach(Callback on_interval, Callback on_compare = nullptr);
+    void detach();
+    void attach_overflow(Callback on_overflow); // Timer 1 only
 
     // Static variables
     volatile uint16_t overflow_counter;
@@ -74,14 +119,79 @@ public:
     volatile uint16_t interval_devisor;
     volatile uint16_t temp_interval_devisor;
 
-    // Static Prescaler Settings
-    static const PrescalerSettings ms_settings_8bit[];
-    static const PrescalerSettings us_settings_8bit[];
-    static const PrescalerSettings ms_settings_16bit[];
-    static const PrescalerSettings us_settings_16bit[];
-
-    // Timer interrupt handler
-    static void handle_timer_interrupt(Timer* timer);
+    // Timer interrupt handlers
+    static bool handle_timer_interrupt(Timer* timer);
+    static void handle_capture_interrupt(Timer* timer);
+    static void handle_overflow_interrupt(Timer* timer);
+
+    //==========================================================================
+    // Static Method: solve
+    // Description: Picks the prescaler, OCR value and software divisor that
+    //              give the smallest period error for the interval. At most
+    //              7 candidates are tried, and constant intervals are solved
+    //              at compile time (e.g. constexpr auto s = Timer::solve(..)).
+    //              Software divided intervals keep at least MIN_ISR_CYCLES
+    //              between compare interrupts to bound the ISR load.
+    //              Intervals above 2^32 CPU cycles (268s at 16MHz) are
+    //              rejected with a prescaler of 0.
+    //==========================================================================
+    static constexpr TimerSettings solve(TimerNum num, TimeUnit unit,
+                                         uint32_t interval) {
+        const uint16_t prescalers[] = { 1, 8, 32, 64, 128, 256, 1024 };
+        const uint32_t max_counts = (num == TIMER1) ? 65536UL : 256UL;
+        const uint32_t cycles_per_unit = F_CPU / (unit == MICROS ? US_PER_SEC 
+                                                                 : MS_PER_SEC);
+        TimerSettings best = { interval, 0, 0, 1, 0 };
+        uint32_t best_error = UINT32_MAX;
+
+        if (interval == 0 || interval > UINT32_MAX / cycles_per_unit) {
+            return best;
+        }
+        const uint32_t cycles = interval * cycles_per_unit;
+
+        for (uint16_t prescaler : prescalers) {
+            // Only timer 2 has the /32 and /128 prescalers
+            if ((prescaler == 32 || prescaler == 128) && num != TIMER2) continue;
+
+            uint32_t total = fixed::div_round(cycles, prescaler);
+            if (total == 0) continue;
+
+            uint32_t divisor = (total + max_counts - 1) / max_counts;
+            if (divisor > UINT16_MAX) continue;
+
+            uint32_t counts = fixed::div_round(total, divisor);
+            if (divisor > 1 && counts * prescaler < MIN_ISR_CYCLES) continue;
+
+            uint32_t achieved = counts * divisor * prescaler;
+            uint32_t error = achieved > cycles ? achieved - cycles
+                                               : cycles - achieved;
+
+            // Smallest error first, then the fewest interrupts
+            if (error < best_error || 
+                (error == best_error && divisor < best.divisor)) {
+                best_error = error;
+                best.prescaler = prescaler;
+                best.ocr = counts - 1;
+                best.divisor = divisor;
+                best.error_ppm = (achieved > cycles) ? (int32_t)ppm(error, cycles)
+                                                     : -(int32_t)ppm(error, cycles);
+            }
+        }
+
+        return best;
+    }
+
+    //==========================================================================
+    // Static Method: ppm
+    // Description: error / cycles in parts per million, in 32 bits so the
+    //              runtime solve() needs no 64-bit division. An error above
+    //              4294 cycles needs a software divisor, which keeps cycles
+    //              above 10^8, so dividing by cycles / 10^6 loses < 1%.
+    //==========================================================================
+    static constexpr uint32_t ppm(uint32_t error, uint32_t cycles) {
+        return (error <= UINT32_MAX / 1000000UL) ? error * 1000000UL / cycles
+                                                 : error / (cycles / 1000000UL);
+    }
 
 private:
     // Constructor
@@ -90,11 +200,19 @@ private:
     // Private variables
     TimerNum _num;
     TimeUnit _unit;
-    uint16_t _adjusted_interval;
+    Callback _on_interval; // Called once per interval (from the ISR)
+    Callback _on_compare;  // Called on every compare match (from the ISR)
+    Callback _on_overflow; // Called on every overflow (timer 1 only)
+
+    // Input capture state (timer 1 only, so shared by all instances)
+    static volatile uint16_t _overflows;                  // Timestamp bits 16-31
+    static volatile uint32_t _capture_ts[CAPTURE_SIZE];   // Edge timestamps
+    static volatile uint8_t  _capture_rising;             // Rising edge flags
+    static volatile uint8_t  _capture_count;              // Edges captured
     
     // Private methods
-    uint16_t set_prescaler(uint32_t interval, Serial &serial);
     void set_mode(TimerMode mode);
+    bool _claim(TimerMode mode);
     void _clear_prescaler_bits();
 };
 
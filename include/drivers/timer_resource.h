@@ -0,0 +1,78 @@
+#ifndef TIMER_RESOURCE_H
+#define TIMER_RESOURCE_H
+
+#include <avr/io.h>
+#include "drivers/timer.h"
+
+//==============================================================================
+// TimerResource Class Declaration
+// Description: Tracks which driver owns each hardware timer (its mode and
+//              clock) and which compare channels it uses. A timer can be
+//              shared by several channels of the same owner, such as two
+//              8-bit PWM pins, but never by two different owners. Timer 0 is
+//              reserved for the SystemClock tick and cannot be claimed.
+//              Releasing the last channel stops the timer and resets its
+//              registers, so the next owner starts from a clean state.
+//==============================================================================
+class TimerResource {
+public:
+    enum Owner : uint8_t {
+        FREE,           // Not in use
+        SYSTEM_CLOCK,   // 1ms tick (timer 0, reserved)
+        PWM_8BIT,       // PWModulation, fast 8-bit PWM
+        PWM_16BIT,      // PWM16, timer 1 with ICR1 as TOP
+        INTERVAL,       // Timer::configure() NORMAL or CTC
+        COUNTER,        // Timer::configure() EXT_CLOCK
+        CAPTURE,        // Timer::start_capture()
+        SOFT_PWM,       // SoftPWM bit-angle modulation (timer 1)
+        ADC_SCAN        // ADCScanner timer 1 compare B trigger
+    };
+
+    // Compare channels (OCnA / OCnB)
+    static constexpr uint8_t CHANNEL_A   = (1 << 0);
+    static constexpr uint8_t CHANNEL_B   = (1 << 1);
+    static constexpr uint8_t CHANNEL_ALL = CHANNEL_A | CHANNEL_B;
+
+    // Public methods
+    static bool claim(Timer::TimerNum num, Owner owner, uint8_t channels);
+    static void release(Timer::TimerNum num, Owner owner, 
+                        uint8_t channels = CHANNEL_ALL);
+    static Owner owner(Timer::TimerNum num);
+    static uint8_t channels(Timer::TimerNum num);
+
+    //==========================================================================
+    // Compile-time helpers
+    // Description: Owners fixed by the firmware and the PWM pin to timer and
+    //              channel map (Arduino Uno pins), so a constant pin choice
+    //              can be checked with static_assert.
+    //==========================================================================
+    static constexpr Owner reserved(Timer::TimerNum num) {
+        return num == Timer::TIMER0 ? SYSTEM_CLOCK : FREE;
+    }
+
+    static constexpr bool is_pwm_pin(uint8_t pin) {
+        return pin == 3 || pin == 5 || pin == 6 || 
+               pin == 9 || pin == 10 || pin == 11;
+    }
+
+    static constexpr Timer::TimerNum pwm_timer(uint8_t pin) {
+        return (pin == 5 || pin == 6)  ? Timer::TIMER0 :
+               (pin == 9 || pin == 10) ? Timer::TIMER1 : Timer::TIMER2;
+    }
+
+    static constexpr uint8_t pwm_channel(uint8_t pin) {
+        return (pin == 6 || pin == 9 || pin == 11) ? CHANNEL_A : CHANNEL_B;
+    }
+
+    static constexpr bool pwm_pin_available(uint8_t pin) {
+        return is_pwm_pin(pin) && reserved(pwm_timer(pin)) == FREE;
+    }
+
+private:
+    static Owner _owner[3];
+    static uint8_t _channels[3];
+
+    static void _reset(Timer::TimerNum num);
+};
+
+#endif // TIMER_RESOURCE_H
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+//==============================================================================
+// Fixed-Point Helpers
+// Description: Integer replacements for float math on the FPU-less AVR.
+//              Everything is constexpr, so constant operands fold at compile
+//              time and no soft-float code is linked.
+//==============================================================================
+namespace fixed {
+
+// Rounded unsigned division
+constexpr uint32_t div_round(uint32_t num, uint32_t den) {
+    return (num + den / 2) / den;
+}
+
+//==============================================================================
+// Scale Template
+// Description: value * num / den for a constant ratio as one 32-bit multiply
+//              and shift (rounded to nearest). The multiplier is computed at
+//              compile time and the static_assert guarantees that no input
+//              up to max_in overflows. apply() can divide by a further
+//              power of two (extra_shift < 16, e.g. oversampled ADC values).
+//==============================================================================
+template <uint32_t num, uint32_t den, uint32_t max_in, uint8_t shift = 16>
+struct Scale {
+    static_assert(den != 0, "den must not be 0");
+
+    static constexpr uint32_t mult = 
+        (uint32_t)((((uint64_t)num << shift) + den / 2) / den);
+
+    static_assert(shift > 0 && shift <= 16, "shift must be 1-16");
+    static_assert((uint64_t)max_in * mult < (1ULL << 31),
+                  "value * mult overflows 31 bits, lower max_in or shift");
+
+    static constexpr uint32_t apply(uint32_t value, uint8_t extra_shift = 0) {
+        return (value * mult + (1UL << (shift + extra_shift - 1))) 
+               >> (shift + extra_shift);
+    }
+};
+
+} // namespace fixed
+
+#endif // FIXED_POINT_H
\ No newline at end of file
@@ -1,10 +1,10 @@
 #ifndef LED_H
 #define LED_H
 
-#include <stdio.h>
 #include "drivers/gpio.h"
-#include "drivers/timer.h"
+#include "drivers/soft_timer.h"
 #include "drivers/adc.h"
+#include "drivers/adc_filter.h"
 #include "drivers/pwm.h"
 #include "drivers/serial.h"
 
@@ -16,6 +16,9 @@ class PWModulation; // Forward Declaration (LED is friend of PWModulation)
 class LED {
 public:
     enum PWM_MODE { PWM_OFF, PWM_ON };
+    static constexpr uint16_t ADC_SAMPLE_MS = 20; // adc_blink sample period
+    static constexpr uint8_t ADC_OVERSAMPLE = 2;  // 12-bit pot readings
+    static constexpr uint16_t INTERVAL_BAND = 1;  // Blink interval hysteresis (ms)
 
     // Constructor that specifies the pin connected to the LED
     LED(uint8_t pin, bool enable_pwm);
@@ -26,11 +29,14 @@ public:
     void toggle();
     bool is_on();
     bool is_off();
-    void blink(uint16_t blink_time, Timer &timer);
-    void adc_blink(Timer &timer, Serial &serial, const uint8_t &adc_ch, 
+    void blink(uint16_t blink_time);
+    void stop_blink();
+    void adc_blink(Serial &serial, const uint8_t &adc_ch, 
                    const uint16_t &max_interval);
     void set_power(const uint16_t &cycle_time);
-    void ramp_brightness(const uint16_t &cycle_time, Timer &timer);
+    void set_level(uint8_t level);
+    void ramp_brightness(const uint16_t &cycle_time);
+    void stop_ramp();
 
 private:
     GPIO _gpio;
@@ -41,8 +47,11 @@ private:
     uint8_t _power;
     uint16_t _blink_interval;
     uint16_t _prev_blink_interval;
-    uint16_t _prev_overflows;
-    uint16_t _overflow_counter;
+    uint8_t _adc_seq;        // Sequence number of the last used ADC sample
+    IIRFilter<3> _adc_filter;   // Pot reading low-pass (8 samples)
+    Hysteresis _interval_hyst;  // Blink interval hysteresis
+    SoftTimer _blink_timer;  // Blink toggle period
+    SoftTimer _sample_timer; // ADC sample period (adc_blink)
 };
 
 #endif // LED_H
\ No newline at end of file
@@ -0,0 +1,273 @@
+//==============================================================================
+// Animation Engine Implementation
+//==============================================================================
+#include "animation.h"
+#include <string.h> // memcpy_P
+
+//==============================================================================
+// Built-in Patterns (flash)
+//==============================================================================
+namespace {
+    using KF = Animation::Keyframe;
+
+    const KF breathe[] PROGMEM = {
+        { 255, Animation::EASE_IN_OUT, 1500 },
+        {   0, Animation::EASE_IN_OUT, 1500 }
+    };
+    const KF heartbeat[] PROGMEM = {
+        { 255, Animation::EASE_OUT,  80 },
+        {   0, Animation::EASE_IN,  150 },
+        { 160, Animation::EASE_OUT,  80 },
+        {   0, Animation::EASE_IN,  400 },
+        {   0, Animation::STEP,     400 }
+    };
+    const KF blink[] PROGMEM = {
+        { 255, Animation::STEP, 500 },
+        {   0, Animation::STEP, 500 }
+    };
+    const KF flash[] PROGMEM = {
+        { 255, Animation::STEP, 950 },
+        {   0, Animation::STEP,  50 }
+    };
+    const KF fade_in[] PROGMEM = {
+        { 255, Animation::LINEAR, 2000 }
+    };
+
+    #define PATTERN(frames, loop) { frames, sizeof(frames) / sizeof(KF), loop }
+    const Animation::Pattern patterns[Animation::USER] PROGMEM = {
+        PATTERN(breathe,   true),
+        PATTERN(heartbeat, true),
+        PATTERN(blink,     true),
+        PATTERN(flash,     true),
+        PATTERN(fade_in,   false)
+    };
+    #undef PATTERN
+}
+
+// Static Members definitions
+Animation::Track Animation::_tracks[Animation::MAX_TRACKS];
+uint8_t Animation::_active = 0;
+SoftTimer Animation::_tick(Animation::_update);
+uint32_t Animation::_last_ms = 0;
+Animation::Keyframe Animation::_user_frames[Animation::MAX_USER_FRAMES];
+uint8_t Animation::_user_count = 0;
+bool Animation::_user_loop = false;
+
+//==============================================================================
+// Public Method: play
+// Description: Play a pattern on an LED from level 0, replacing what it was
+//              playing. offset_ms starts the pattern part way in, so LEDs of
+//              a panel can run the same pattern out of phase. Returns false
+//              for an unknown (or empty USER) pattern or if all tracks are
+//              in use.
+//==============================================================================
+bool Animation::play(LED &led, uint8_t pattern, uint16_t offset_ms) {
+    if (pattern >= PATTERN_COUNT || (pattern == USER && _user_count == 0)) {
+        return false;
+    }
+
+    uint8_t i = 0;
+    while (i < _active && _tracks[i].led != &led) i++;
+    if (i == MAX_TRACKS) return false;
+    if (i == _active) _active++;
+
+    Track &track = _tracks[i];
+    track.led = &led;
+    track.pattern = pattern;
+    track.frame = 0;
+    track.from = 0;
+    track.elapsed = 0;
+
+    if (!_tick.is_active()) {
+        _last_ms = SystemClock::millis();
+        _tick.start_periodic(TICK_MS);
+    }
+    if (!_advance(track, offset_ms)) _remove(i);
+    return true;
+}
+
+//==============================================================================
+// Public Methods: stop, stop_all, is_playing
+// Description: Stopping leaves the LEDs at their current level.
+//==============================================================================
+void Animation::stop(LED &led) {
+    for (uint8_t i = 0; i < _active; i++) {
+        if (_tracks[i].led == &led) {
+            _remove(i);
+            return;
+        }
+    }
+}
+
+void Animation::stop_all() {
+    _active = 0;
+    _tick.stop();
+}
+
+bool Animation::is_playing(const LED &led) {
+    for (uint8_t i = 0; i < _active; i++) {
+        if (_tracks[i].led == &led) return true;
+    }
+    return false;
+}
+
+//==============================================================================
+// Public Method: load
+// Description: Load the USER pattern from its serial format: a loop flag
+//              (0 or 1), the index of the first keyframe, then keyframes of
+//              level, easing and duration (uint16_t, little-endian). One
+//              serial frame only holds LOAD_FRAMES keyframes, so longer
+//              patterns are sent in chunks: index 0 starts a new pattern,
+//              each further chunk continues at the current length (or
+//              rewrites from an earlier index). The pattern ends after the
+//              last keyframe loaded. A looping pattern needs a non-zero
+//              total duration. LEDs playing USER restart.
+//==============================================================================
+bool Animation::load(const uint8_t* data, uint8_t length) {
+    constexpr uint8_t header = 2;
+    constexpr uint8_t frame_size = 4;
+    if (length < header + frame_size || (length - header) % frame_size != 0) {
+        return false;
+    }
+
+    bool loop = data[0];
+    uint8_t index = data[1];
+    uint8_t count = (length - header) / frame_size;
+    if (data[0] > 1 || index > _user_count || 
+        count > MAX_USER_FRAMES - index) {
+        return false;
+    }
+
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < index; i++) total += _user_frames[i].duration;
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t* kf = data + header + i * frame_size;
+        if (kf[1] > EASE_IN_OUT) return false;
+        total += kf[2] | ((uint16_t)kf[3] << 8);
+    }
+    if (loop && total == 0) return false;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t* kf = data + header + i * frame_size;
+        Keyframe &frame = _user_frames[index + i];
+        frame.level = kf[0];
+        frame.easing = kf[1];
+        frame.duration = kf[2] | ((uint16_t)kf[3] << 8);
+    }
+    _user_count = index + count;
+    _user_loop = loop;
+
+    for (uint8_t i = 0; i < _active; i++) {
+        if (_tracks[i].pattern == USER) {
+            _tracks[i].frame = 0;
+            _tracks[i].elapsed = 0;
+        }
+    }
+    return true;
+}
+
+//==============================================================================
+// Private Method: _update
+// Description: Soft timer callback, advances every playing track by the time
+//              since the last tick, so a slow main loop does not slow the
+//              animations down.
+//==============================================================================
+void Animation::_update(void* context) {
+    (void)context;
+    uint32_t now = SystemClock::millis();
+    uint32_t dt = now - _last_ms;
+    _last_ms = now;
+    if (dt > UINT16_MAX) dt = UINT16_MAX;
+
+    for (uint8_t i = 0; i < _active; ) {
+        if (_advance(_tracks[i], dt)) {
+            i++;
+        } else {
+            _remove(i); // Finished, the last track moves into slot i
+        }
+    }
+}
+
+//==============================================================================
+// Private Method: _advance
+// Description: Move a track dt ms forward and set its LED level. Returns
+//              false when a non-looping pattern has finished.
+//==============================================================================
+bool Animation::_advance(Track &track, uint16_t dt) {
+    Pattern p;
+    Keyframe kf;
+    _pattern(track.pattern, p);
+    _keyframe(track.pattern, p, track.frame, kf);
+
+    uint32_t elapsed = (uint32_t)track.elapsed + dt;
+    while (elapsed >= kf.duration) {
+        elapsed -= kf.duration;
+        track.from = kf.level;
+        if (++track.frame >= p.count) {
+            if (!p.loop) {
+                track.led->set_level(kf.level);
+                return false;
+            }
+            track.frame = 0;
+        }
+        _keyframe(track.pattern, p, track.frame, kf);
+    }
+    track.elapsed = elapsed;
+
+    uint16_t t = ((uint32_t)elapsed << 8) / kf.duration; // Progress (Q8)
+    int16_t delta = (int16_t)kf.level - track.from;
+    track.led->set_level(track.from + ((int32_t)delta * _ease(kf.easing, t)) / 256);
+    return true;
+}
+
+//==============================================================================
+// Private Method: _remove
+// Description: Stop a track in O(1) by moving the last playing track into it.
+//==============================================================================
+void Animation::_remove(uint8_t index) {
+    _tracks[index] = _tracks[--_active];
+    if (_active == 0) _tick.stop();
+}
+
+//==============================================================================
+// Private Methods: _pattern, _keyframe
+// Description: Read a pattern and its keyframes from flash, or from RAM for
+//              the USER pattern.
+//==============================================================================
+void Animation::_pattern(uint8_t pattern, Pattern &out) {
+    if (pattern == USER) {
+        out = { _user_frames, _user_count, _user_loop };
+    } else {
+        memcpy_P(&out, &patterns[pattern], sizeof(out));
+    }
+}
+
+void Animation::_keyframe(uint8_t pattern, const Pattern &p, uint8_t index,
+                          Keyframe &out) {
+    if (pattern == USER) {
+        out = p.frames[index];
+    } else {
+        memcpy_P(&out, &p.frames[index], sizeof(out));
+    }
+}
+
+//==============================================================================
+// Private Method: _ease
+// Description: Map linear progress t (0-256) to eased progress (0-256).
+//==============================================================================
+uint16_t Animation::_ease(uint8_t easing, uint16_t t) {
+    switch (easing) {
+        case STEP:
+            return 0; // t < 256 while the keyframe runs
+        case EASE_IN:
+            return ((uint32_t)t * t) >> 8;
+        case EASE_OUT: {
+            uint16_t r = 256 - t;
+            return 256 - (((uint32_t)r * r) >> 8);
+        }
+        case EASE_IN_OUT:
+            return ((uint32_t)t * t * (768 - 2 * t)) >> 16; // t^2 (3 - 2t)
+        default:
+            return t; // LINEAR
+    }
+}
\ No newline at end of file
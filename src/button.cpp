@@ -2,13 +2,12 @@
 // Button Class Implementation
 //==============================================================================
 #include "button.h"
-#include <stdio.h> // sprintf
 
 //==============================================================================
 // Button Constructor
 //==============================================================================
 Button::Button(uint8_t pin) : _gpio(GPIO::DIGITAL_PIN, pin), _pin(pin),
-                              _button_presses(0) {}
+                              _button_presses(0), _report_timer() {}
 
 //==============================================================================
 // Button Public Methods: init
@@ -22,18 +21,21 @@ void Button::init() {
 }
 
 //==============================================================================
-// Button Public Methods: is_pressed, print_presses
+// Button Public Methods: is_pressed, print_presses, stop_report
+// Description: stop_report must be called when the presses are no longer
+//              printed, so the next print_presses starts a full interval
+//              from its first call.
 //==============================================================================
 bool Button::is_pressed() { 
     return _gpio.is_low();
 }
 
-void Button::print_presses(const uint16_t &interval, Timer &timer, Serial &serial) {
+void Button::print_presses(const uint16_t &interval, Serial &serial) {
 
     /*
     * This function uses a hardware timer to track button presses, efficiently
-    * reducing CPU load by avoiding continuous polling. The timer's overflow
-    * is checked to report button presses.
+    * reducing CPU load by avoiding continuous polling. A soft timer reports
+    * the button presses once per interval.
     * 
     * To enhance button press detection reliability, consider hardware
     * debouncing. Options include:
@@ -53,15 +55,19 @@ void Button::print_presses(const uint16_t &interval, Timer &timer, Serial &seria
     * more accurate software responses to user inputs.
     */
 
-    if (timer.overflow_counter >= interval) {
-        timer.overflow_counter = 0; // Reset the counter after printing
-        char buf[32];
-        sprintf(buf, "Button presses: %u\r\n", TCNT1);
-        serial.uart_put_str(buf);
+    if (!_report_timer.is_active() || _report_timer.period() != interval)
+        _report_timer.start_periodic(interval);
+
+    if (_report_timer.expired()) {
+        serial.uart_printf_P(PSTR("Button presses: %u\r\n"), TCNT1);
         TCNT1 = 0; // Reset the timer counter 
     }
 }
 
+void Button::stop_report() {
+    _report_timer.stop();
+}
+
 //==============================================================================
 // Constexpr validation for pin change interrupt pins on Arduino Uno
 //==============================================================================
@@ -2,49 +2,189 @@
 // CommandParser Class Implementation
 //==============================================================================
 #include "command.h"
+#include "animation.h"
 
 namespace cmdlimit {
     constexpr uint8_t  max_power  = 255;
     constexpr uint16_t min_freq_t = 200;
     constexpr uint16_t max_freq_t = 5000;
     constexpr uint16_t max_ramp_t = 5000;
+    constexpr uint8_t  max_adc_ch = 7;
+    constexpr uint8_t  max_trig   = 255;
+    constexpr uint8_t  max_anim   = Animation::PATTERN_COUNT - 1;
 }
 
 //==============================================================================
 // Public Method: parseCommand
+// Description: Parses a command line in place from the UART receive buffer.
+//              Expects a command word followed by up to two unsigned values.
 //==============================================================================
-void Command::parse_cmd(const char* cmd_input) {
-    const char* cmd_ledblink     = "ledblink";
-    const char* cmd_ledadc       = "ledadc";
-    const char* cmd_ledpowerfreq = "ledpowerfreq";
-    const char* cmd_button       = "button";
-    const char* cmd_ledramptime  = "ledramptime";
+void Command::parse_cmd(const LineView& line) {
+    static const char cmd_ledblink[]     PROGMEM = "ledblink";
+    static const char cmd_ledadc[]       PROGMEM = "ledadc";
+    static const char cmd_ledpowerfreq[] PROGMEM = "ledpowerfreq";
+    static const char cmd_button[]       PROGMEM = "button";
+    static const char cmd_ledramptime[]  PROGMEM = "ledramptime";
+    static const char cmd_capture[]      PROGMEM = "capture";
+    static const char cmd_scope[]        PROGMEM = "scope";
+    static const char cmd_anim[]         PROGMEM = "anim";
+    static const char cmd_uartstats[]    PROGMEM = "uartstats";
+    static const char cmd_cpuload[]      PROGMEM = "cpuload";
+
+    uint8_t pos = 0;
+    uint8_t len = 0;
+    int res = 0;
 
     // Parse the command string and prevent buffer overflow with max length 16
-    int res = sscanf(cmd_input, "%16s %u %u", cmd_string, &cmd_val1, &cmd_val2);
+    while (pos < line.length() && _is_space(line[pos])) pos++;
+    while (pos < line.length() && !_is_space(line[pos]) && len < 16) {
+        cmd_string[len++] = line[pos++];
+    }
+    cmd_string[len] = '\0';
+    if (len > 0) res++;
+
+    // Parse up to two unsigned values following the command word
+    uint16_t* values[] = { &cmd_val1, &cmd_val2 };
+    for (uint8_t i = 0; i < 2 && res == i + 1; i++) {
+        while (pos < line.length() && _is_space(line[pos])) pos++;
+        if (pos >= line.length() || !_is_digit(line[pos])) break;
+
+        uint32_t value = 0;
+        while (pos < line.length() && _is_digit(line[pos])) {
+            if (value <= UINT16_MAX) value = value * 10 + (line[pos] - '0');
+            pos++;
+        }
+        *values[i] = value > UINT16_MAX ? UINT16_MAX : value;
+        res++;
+    }
 
     // Now compare the first word of the string to the cmd's
-    if (strncmp(cmd_string, cmd_ledblink, strlen(cmd_ledblink)) == 0) {
+    if (strncmp_P(cmd_string, cmd_ledblink, strlen_P(cmd_ledblink)) == 0) {
         if (res == 1) cmd = LED_BLINK;
     }
-    else if (strncmp(cmd_string, cmd_ledadc, strlen(cmd_ledadc)) == 0) {
+    else if (strncmp_P(cmd_string, cmd_ledadc, strlen_P(cmd_ledadc)) == 0) {
         if (res == 1) cmd = LED_ADC;
     }
-    else if (strncmp(cmd_string, cmd_ledpowerfreq, strlen(cmd_ledpowerfreq)) == 0) {
+    else if (strncmp_P(cmd_string, cmd_ledpowerfreq, strlen_P(cmd_ledpowerfreq)) == 0) {
         if (res == 3 && 
             cmd_val1 <= cmdlimit::max_power && 
             cmd_val2 >= cmdlimit::min_freq_t && cmd_val2 <= cmdlimit::max_freq_t) { 
             cmd = LED_PWR;
         } else { cmd = NO_CMD; }
     }
-    else if (strncmp(cmd_string, cmd_button, strlen(cmd_button)) == 0) {
+    else if (strncmp_P(cmd_string, cmd_button, strlen_P(cmd_button)) == 0) {
         if (res == 1) cmd = BUTTON;
     }
-    else if (strncmp(cmd_string, cmd_ledramptime, strlen(cmd_ledramptime)) == 0) {
+    else if (strncmp_P(cmd_string, cmd_ledramptime, strlen_P(cmd_ledramptime)) == 0) {
         if (res == 2 && cmd_val1 <= cmdlimit::max_ramp_t) {
             cmd = LED_RAMP;
         } else { cmd = NO_CMD; } 
+    }
+    else if (strncmp_P(cmd_string, cmd_capture, strlen_P(cmd_capture)) == 0) {
+        if (res == 1) cmd = CAPTURE;
+    }
+    else if (strncmp_P(cmd_string, cmd_scope, strlen_P(cmd_scope)) == 0) {
+        if (res == 3 && cmd_val1 <= cmdlimit::max_adc_ch && 
+            cmd_val2 <= cmdlimit::max_trig) {
+            cmd = SCOPE;
+        } else { cmd = NO_CMD; }
+    }
+    else if (strncmp_P(cmd_string, cmd_anim, strlen_P(cmd_anim)) == 0) {
+        if (res == 2 && cmd_val1 <= cmdlimit::max_anim) {
+            cmd = ANIMATE;
+        } else { cmd = NO_CMD; }
+    }
+    else if (strncmp_P(cmd_string, cmd_uartstats, strlen_P(cmd_uartstats)) == 0) {
+        if (res == 1) query = UART_STATS; // Keep the running command
+    }
+    else if (strncmp_P(cmd_string, cmd_cpuload, strlen_P(cmd_cpuload)) == 0) {
+        if (res == 1) query = CPU_LOAD;
     } else {
         cmd = NO_CMD;
     }
+}
+
+//==============================================================================
+// Public Method: parse_frame
+// Description: Parses a decoded binary frame. The first byte is the opcode
+//              (a Commands value), followed by the command's fixed-width
+//              uint16_t arguments in little-endian order:
+//                NO_CMD, LED_BLINK, LED_ADC, BUTTON, CAPTURE: no arguments
+//                LED_PWR:  <power> <freq>
+//                LED_RAMP: <time>
+//                SCOPE:    <channel> <threshold>
+//                ANIMATE:  <pattern>
+//              Queries (FRAME_QUERY | Queries value) take no arguments,
+//              except ANIM_LOAD which carries a USER pattern chunk (see
+//              Animation::load) in data / data_length.
+//              The current command is only replaced if the frame is valid.
+//==============================================================================
+bool Command::parse_frame(const uint8_t* frame, uint8_t length) {
+    if (length == 0) return false;
+
+    uint8_t frame_query = frame[0] ^ FRAME_QUERY;
+    if (frame_query == UART_STATS || frame_query == CPU_LOAD) {
+        if (length != 1) return false;
+        query = frame_query;
+        return true;
+    }
+    if (frame_query == ANIM_LOAD) {
+        if (length < 2) return false;
+        query = frame_query;
+        data = frame + 1;
+        data_length = length - 1;
+        return true;
+    }
+
+    uint16_t val1 = length >= 3 ? (frame[1] | ((uint16_t)frame[2] << 8)) : 0;
+    uint16_t val2 = length >= 5 ? (frame[3] | ((uint16_t)frame[4] << 8)) : 0;
+    bool valid;
+
+    switch (frame[0]) {
+        case NO_CMD:
+        case LED_BLINK:
+        case LED_ADC:
+        case BUTTON:
+        case CAPTURE:
+            valid = (length == 1);
+            break;
+        case LED_PWR:
+            valid = (length == 5 &&
+                     val1 <= cmdlimit::max_power &&
+                     val2 >= cmdlimit::min_freq_t && 
+                     val2 <= cmdlimit::max_freq_t);
+            break;
+        case LED_RAMP:
+            valid = (length == 3 && val1 <= cmdlimit::max_ramp_t);
+            break;
+        case ANIMATE:
+            valid = (length == 3 && val1 <= cmdlimit::max_anim);
+            break;
+        case SCOPE:
+            valid = (length == 5 && 
+                     val1 <= cmdlimit::max_adc_ch && 
+                     val2 <= cmdlimit::max_trig);
+            break;
+        default:
+            valid = false;
+            break;
+    }
+
+    if (valid) {
+        cmd = frame[0];
+        cmd_val1 = val1;
+        cmd_val2 = val2;
+    }
+    return valid;
+}
+
+//==============================================================================
+// Private Methods: _is_space, _is_digit
+//==============================================================================
+bool Command::_is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool Command::_is_digit(char c) {
+    return c >= '0' && c <= '9';
 }
\ No newline at end of file
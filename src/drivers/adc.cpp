@@ -2,6 +2,40 @@
 // ADC Interface Class Implementation
 //==============================================================================
 #include "drivers/adc.h"
+#include "drivers/timer_resource.h"
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
+
+// Static Members definitions
+volatile uint16_t ADConverter::_value = 0;
+volatile uint8_t ADConverter::_channel = 0;
+volatile uint8_t ADConverter::_seq = 0;
+volatile bool ADConverter::_busy = false;
+ADConverter::Callback ADConverter::_callback = nullptr;
+
+uint8_t ADCScanner::_channels[ADCScanner::MAX_CHANNELS];
+uint8_t ADCScanner::_count = 0;
+uint8_t ADCScanner::_trigger = ADCScanner::TRIGGER_TIMER0_COMPA;
+volatile uint8_t ADCScanner::_pos = 0;
+volatile bool ADCScanner::_settling = false;
+volatile bool ADCScanner::_running = false;
+volatile uint16_t ADCScanner::_slots[ADCScanner::MAX_CHANNELS][2];
+volatile uint8_t ADCScanner::_latest[ADCScanner::MAX_CHANNELS];
+volatile uint8_t ADCScanner::_seq[ADCScanner::MAX_CHANNELS];
+uint8_t ADCScanner::_oversample = 0;
+uint16_t ADCScanner::_acc[ADCScanner::MAX_CHANNELS];
+uint8_t ADCScanner::_acc_count[ADCScanner::MAX_CHANNELS];
+
+uint8_t ADCCapture::_buffer[ADCCapture::BUFFER_SIZE];
+volatile uint8_t ADCCapture::_pos = 0;
+volatile uint8_t ADCCapture::_state = ADCCapture::IDLE;
+volatile uint16_t ADCCapture::_remaining = 0;
+volatile uint16_t ADCCapture::_late = 0;
+uint8_t ADCCapture::_threshold = 0;
+uint8_t ADCCapture::_pre_trigger = 0;
+uint8_t ADCCapture::_prev = 0;
+uint8_t ADCCapture::_prescaler = ADCCapture::DIV_128;
 
 //==============================================================================
 // Constructor
@@ -15,12 +49,28 @@ ADConverter::ADConverter() {
 
 //==============================================================================
 // Public Method: Read
-// Description:   Read the value from the specified ADC channel
+// Description:   Read the value from the specified ADC channel (blocking,
+//                about 104us at the /128 prescaler). A running non-blocking
+//                conversion is completed first. While the ADCScanner runs,
+//                the last scanned value of the channel is returned instead
+//                (0 if the channel is not scanned).
 //==============================================================================
 uint16_t ADConverter::read_channel(uint8_t ch) {
+    if (ADCScanner::is_running()) {
+        uint16_t value = 0;
+        uint8_t seq;
+        ADCScanner::read(ch, value, seq);
+        return value;
+    }
+
+    while (_busy);
+
     // Mask the channel number to ensure it is within 0 to 7
     ch &= 0b00000111;
 
+    // Poll the conversion instead of the conversion complete interrupt
+    ADCSRA &= ~(1<<ADIE);
+
     // Set the selected channel on ADMUX; clear previous channel selection
     ADMUX = (ADMUX & 0xF8) | ch;  // Clear lowest three bits and set new channel
 
@@ -34,7 +84,362 @@ uint16_t ADConverter::read_channel(uint8_t ch) {
     return ADC;
 }
 
-void ADConverter::convert_to_mv(uint16_t &adc_value) {
-    float voltage_ratio = static_cast<float>(adc_value) * MAX_INPUT_VOLTAGE;
-    adc_value = static_cast<uint16_t>(voltage_ratio / MAX_ADC_VALUE);
+//==============================================================================
+// Public Method: read_channel_quiet
+// Description:   Blocking read with the CPU in ADC Noise Reduction sleep
+//                during the conversion, which halts the CPU and I/O clocks
+//                to reduce digital noise. Timer 0 stops too, so the
+//                SystemClock falls behind by up to one conversion (~104us)
+//                per call. Other interrupts may end the sleep early, the
+//                CPU then sleeps again until the result is ready.
+//==============================================================================
+uint16_t ADConverter::read_channel_quiet(uint8_t ch) {
+    if (ADCScanner::is_running()) return read_channel(ch);
+
+    while (!start_conversion(ch));
+
+    set_sleep_mode(SLEEP_MODE_ADC);
+    while (true) {
+        cli();
+        if (!_busy) break;
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+    }
+    sei();
+    set_sleep_mode(SLEEP_MODE_IDLE); // Mode used by Power::idle()
+
+    return _value;
+}
+
+//==============================================================================
+// Public Methods: start_conversion, is_busy, get_sample, set_callback
+// Description:   Non-blocking conversions. start_conversion() returns at once
+//                (false if a conversion is still running) and ADC_vect stores
+//                the result with a new sequence number. Poll get_sample() and
+//                compare the sequence number, or set a callback that runs in
+//                the ISR when the result is ready.
+//==============================================================================
+bool ADConverter::start_conversion(uint8_t ch) {
+    if (_busy || ADCScanner::is_running()) return false;
+
+    _busy = true;
+    ADMUX = (ADMUX & 0xF8) | (ch & 0b00000111);
+    ADCSRA |= (1<<ADIE) | (1<<ADSC);  // Interrupt on completion
+    return true;
+}
+
+bool ADConverter::is_busy() {
+    return _busy;
+}
+
+bool ADConverter::get_sample(Sample &sample) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        sample.value = _value;
+        sample.channel = _channel;
+        sample.seq = _seq;
+    }
+    return sample.seq != 0;
+}
+
+void ADConverter::set_callback(Callback callback) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _callback = callback;
+    }
+}
+
+//==============================================================================
+// ISR ADC Conversion Complete
+//==============================================================================
+ISR(ADC_vect) {
+    if (ADCCapture::is_running()) {
+        ADCCapture::handle_conversion_complete();
+    } else if (ADCScanner::is_running()) {
+        ADCScanner::handle_conversion_complete();
+    } else {
+        ADConverter::handle_conversion_complete();
+    }
+}
+
+void ADConverter::handle_conversion_complete() {
+    _value = ADC;
+    _channel = ADMUX & 0x07;
+    _seq = (_seq == UINT8_MAX) ? 1 : _seq + 1;  // 0 means no result yet
+    _busy = false;
+    ADCSRA &= ~(1<<ADIE);
+
+    if (_callback) _callback(_channel, _value);
+}
+
+//==============================================================================
+// ADCScanner Public Methods: start, stop, is_running
+// Description:   start() copies the channel list and arms the auto trigger.
+//                A running non-blocking conversion is completed first. The
+//                timer 1 trigger fails if timer 1 is owned by another driver
+//                or period_us is 0, stop() releases it again.
+//==============================================================================
+bool ADCScanner::start(const uint8_t* channels, uint8_t count, 
+                       Trigger trigger, uint8_t oversample, uint16_t period_us) {
+    if (count == 0 || count > MAX_CHANNELS) return false;
+    if (oversample > MAX_OVERSAMPLE) return false;
+
+    if (trigger == TRIGGER_TIMER1_COMPB) {
+        Timer::TimerSettings s = Timer::solve(Timer::TIMER1, Timer::MICROS, 
+                                              period_us);
+        if (s.prescaler == 0 || s.divisor != 1) return false;
+        if (!TimerResource::claim(Timer::TIMER1, TimerResource::ADC_SCAN,
+                                  TimerResource::CHANNEL_ALL)) {
+            return false;
+        }
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            TCCR1A = 0;
+            TCCR1B = (1 << WGM12); // CTC, stopped until the scan is armed
+            OCR1A  = s.ocr;
+            OCR1B  = s.ocr;        // OCF1B once per period, at TOP
+            TCNT1  = 0;
+            TIFR1  = (1 << OCF1B);
+            TCCR1B |= TIMER1_PS_BITS(s.prescaler);
+        }
+    } else {
+        TimerResource::release(Timer::TIMER1, TimerResource::ADC_SCAN);
+    }
+    while (ADConverter::is_busy());
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t i = 0; i < count; i++) {
+            _channels[i] = channels[i] & 0b00000111;
+            _latest[i] = 0;
+            _seq[i] = 0;
+            _acc[i] = 0;
+            _acc_count[i] = 0;
+        }
+        _oversample = oversample;
+        _trigger = trigger;
+        _count = count;
+        _pos = 0;
+        _settling = true; // The mux may have been on another channel
+        _running = true;
+
+        ADMUX = (ADMUX & 0xF8) | _channels[0];
+        ADCSRB = (ADCSRB & ~((1 << ADTS2) | (1 << ADTS1) | (1 << ADTS0))) 
+               | trigger;
+        ADCSRA |= (1 << ADATE) | (1 << ADIE);
+    }
+    return true;
+}
+
+void ADCScanner::stop() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ADCSRA &= ~((1 << ADATE) | (1 << ADIE));
+        _running = false;
+    }
+    while (ADCSRA & (1 << ADSC)); // Let a started conversion finish
+    TimerResource::release(Timer::TIMER1, TimerResource::ADC_SCAN);
+}
+
+bool ADCScanner::is_running() {
+    return _running;
+}
+
+//==============================================================================
+// ADCScanner Public Method: read
+// Description:   Latest result of a scanned channel and its sequence number
+//                (1-255, increments per result). Returns false if the channel
+//                is not scanned or has no result yet.
+//==============================================================================
+bool ADCScanner::read(uint8_t ch, uint16_t &value, uint8_t &seq) {
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_channels[i] != ch) continue;
+
+        // The ISR only writes the other slot, so this read is not torn
+        // (unless the reader is stalled for a full scan cycle)
+        seq = _seq[i];
+        value = _slots[i][_latest[i]];
+        return seq != 0;
+    }
+    return false;
+}
+
+//==============================================================================
+// ADCScanner Interrupt Handler
+//==============================================================================
+void ADCScanner::handle_conversion_complete() {
+    uint16_t value = ADC;
+
+    // No ISR clears OCF1B, without a falling edge the scan would stop here
+    if (_trigger == TRIGGER_TIMER1_COMPB) TIFR1 = (1 << OCF1B);
+
+    // First conversion after a mux switch, convert the channel again now
+    if (_settling) {
+        _settling = false;
+        ADCSRA |= (1 << ADSC);
+        return;
+    }
+
+    uint8_t pos = _pos;
+
+    bool publish = true;
+
+    // Oversampling: sum 4^n samples, publish the sum >> n
+    if (_oversample) {
+        _acc[pos] += value;
+        if (++_acc_count[pos] < (1 << (2 * _oversample))) {
+            publish = false; // Sum not complete yet
+        } else {
+            value = _acc[pos] >> _oversample;
+            _acc[pos] = 0;
+            _acc_count[pos] = 0;
+        }
+    }
+
+    if (publish) {
+        uint8_t slot = _latest[pos] ^ 1;
+        _slots[pos][slot] = value;
+        _latest[pos] = slot;
+        _seq[pos] = (_seq[pos] == UINT8_MAX) ? 1 : _seq[pos] + 1;
+    }
+
+    // Next trigger converts the next channel of the list
+    if (_count > 1) {
+        pos = (pos + 1 == _count) ? 0 : pos + 1;
+        _pos = pos;
+        ADMUX = (ADMUX & 0xF8) | _channels[pos];
+        _settling = true;
+    }
+}
+
+//==============================================================================
+// ADCCapture Public Methods: start, stop, is_running, is_done
+// Description:   start() needs the ADC to be free (no scan or conversion
+//                running). stop() ends a capture early and restores the
+//                /128 prescaler and right adjusted results for the other
+//                ADC users. After a completed capture the samples stay
+//                readable until the next start().
+//==============================================================================
+bool ADCCapture::start(uint8_t ch, Prescaler prescaler, uint8_t threshold,
+                       uint8_t pre_trigger) {
+    if (ADCScanner::is_running() || ADConverter::is_busy() || is_running()) {
+        return false;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _pos = 0;
+        _late = 0;
+        _threshold = threshold;
+        _pre_trigger = pre_trigger;
+        _prescaler = prescaler;
+        _prev = UINT8_MAX;               // No crossing on the first sample
+        _remaining = pre_trigger;
+        _state = pre_trigger ? PRE_TRIGGER : ARMED;
+
+        ADMUX = (ADMUX & 0xF8) | (1 << ADLAR) | (ch & 0b00000111);
+        ADCSRB &= ~((1 << ADTS2) | (1 << ADTS1) | (1 << ADTS0)); // Free running
+        ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADATE) | (1 << ADIF) |
+                 (1 << ADIE) | prescaler;
+    }
+    return true;
+}
+
+void ADCCapture::stop() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // Nothing to restore (ADLAR is only set by a capture)
+        if (!is_running() && !(ADMUX & (1 << ADLAR))) return;
+        if (_state != DONE) _state = IDLE;
+        ADCSRA = (1 << ADEN) | (1 << ADIF) | DIV_128;
+        ADMUX &= ~(1 << ADLAR);
+    }
+}
+
+bool ADCCapture::is_running() {
+    return _state != IDLE && _state != DONE;
+}
+
+bool ADCCapture::is_done() {
+    return _state == DONE;
+}
+
+//==============================================================================
+// ADCCapture Public Methods: sample, sample_rate, late_count
+//==============================================================================
+uint8_t ADCCapture::sample(uint8_t index) {
+    return _buffer[(uint8_t)(_pos + index)]; // _pos is the oldest when done
+}
+
+uint32_t ADCCapture::sample_rate() {
+    return F_CPU / (1UL << (_prescaler & 0x07)) / 13;
+}
+
+uint16_t ADCCapture::late_count() {
+    uint16_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        count = _late;
+    }
+    return count;
+}
+
+//==============================================================================
+// ADCCapture Interrupt Handler
+// Description: ADIF is cleared when the vector runs, so finding it set again
+//              on the way out means the next conversion completed before this
+//              sample was handled. The ISR ran late (the next result may be
+//              overwritten before it is read) and the sample is counted.
+//==============================================================================
+void ADCCapture::handle_conversion_complete() {
+    uint8_t value = ADCH;
+    uint8_t pos = _pos;
+    _buffer[pos] = value;
+    _pos = pos + 1;
+
+    switch (_state) {
+        case PRE_TRIGGER:
+            if (--_remaining == 0) _state = ARMED;
+            break;
+        case ARMED:
+            if (_threshold && !(_prev < _threshold && value >= _threshold)) {
+                break;
+            }
+            _state = TRIGGERED;
+            _remaining = BUFFER_SIZE - _pre_trigger; // Includes this sample
+            // fall through
+        case TRIGGERED:
+            if (--_remaining == 0) {
+                ADCSRA &= ~((1 << ADATE) | (1 << ADIE)); // Stop free running
+                _state = DONE;
+            }
+            break;
+    }
+    _prev = value;
+    if (ADCSRA & (1 << ADIF)) _late++;
+}
+
+//==============================================================================
+// Public Method: convert_to_mv
+// Description:   Scale a reading to millivolts with a compile-time constant
+//                multiply and shift instead of float math. extra_bits is the
+//                resolution above 10 bits of oversampled values (ADCScanner).
+//==============================================================================
+using AdcToMv = fixed::Scale<ADConverter::MAX_INPUT_VOLTAGE, 
+                             ADConverter::MAX_ADC_VALUE,
+                             ADConverter::MAX_ADC_VALUE << ADCScanner::MAX_OVERSAMPLE,
+                             15>;
+
+void ADConverter::convert_to_mv(uint16_t &adc_value, uint8_t extra_bits) {
+    adc_value = AdcToMv::apply(adc_value, extra_bits);
+}
+
+// Compile-time check against the previous float conversion (truncated): the
+// fixed-point result is rounded, so it may only be 1mV above it
+constexpr bool _mv_matches_float(uint8_t extra_bits) {
+    const uint32_t max = (uint32_t)ADConverter::MAX_ADC_VALUE << extra_bits;
+    for (uint32_t value = 0; value <= max; value++) {
+        const uint32_t fixed = AdcToMv::apply(value, extra_bits);
+        const uint32_t ref = (uint32_t)((double)value * 
+                             ADConverter::MAX_INPUT_VOLTAGE / max);
+        if (fixed != ref && fixed != ref + 1) return false;
+    }
+    return true;
 }
+static_assert(_mv_matches_float(0) && _mv_matches_float(1) &&
+              _mv_matches_float(2) && _mv_matches_float(3),
+              "convert_to_mv differs from the float conversion by more than 1mV");
@@ -0,0 +1,117 @@
+//==============================================================================
+// System Clock Implementation
+//==============================================================================
+#include "drivers/clock.h"
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+// Static Members definitions
+constexpr Timer::TimerSettings SystemClock::tick;
+volatile uint32_t SystemClock::_millis = 0;
+volatile SystemClock::Callback SystemClock::_on_tick = nullptr;
+
+//==============================================================================
+// ISR Timer 0 Compare Match A (the system tick, timer 0 is reserved for it)
+//==============================================================================
+ISR(TIMER0_COMPA_vect) {
+    SystemClock::handle_tick();
+    if (timer0_compare_hook) timer0_compare_hook();
+}
+
+void SystemClock::handle_tick() {
+    _millis = _millis + 1;
+    Callback on_tick = _on_tick;
+    if (on_tick) on_tick();
+}
+
+//==============================================================================
+// Public Method: init
+// Description: Start timer 0 in CTC mode with a 1ms compare interrupt.
+//==============================================================================
+void SystemClock::init() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TCCR0A = (1 << WGM01);                   // CTC mode
+        TCCR0B = TIMER0_PS_BITS(tick.prescaler); // Prescaler
+        OCR0A  = tick.ocr;
+        TCNT0  = 0;
+        TIFR0  = (1 << OCF0A);                   // Clear a pending match
+        TIMSK0 |= (1 << OCIE0A);                 // Enable the tick interrupt
+        _millis = 0;
+    }
+}
+
+//==============================================================================
+// Public Methods: millis, micros
+// Description: Read the clock atomically. micros() combines the millisecond
+//              count with TCNT0 and accounts for a compare match that has
+//              happened but whose interrupt has not run yet.
+//==============================================================================
+uint32_t SystemClock::millis() {
+    uint32_t ms;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms = _millis;
+    }
+    return ms;
+}
+
+uint32_t SystemClock::micros() {
+    uint32_t ms;
+    uint8_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms = _millis;
+        count = TCNT0;
+        // Counter wrapped but the tick ISR is still pending
+        if ((TIFR0 & (1 << OCF0A)) && count < tick.ocr) ms++;
+    }
+    return ms * 1000UL + (uint16_t)count * US_PER_COUNT;
+}
+
+//==============================================================================
+// Public Methods: elapsed_ms, elapsed_us, has_elapsed
+// Description: Unsigned subtraction keeps these correct across wraparound
+//              (49 days for millis, 71 minutes for micros).
+//==============================================================================
+uint32_t SystemClock::elapsed_ms(uint32_t since) {
+    return millis() - since;
+}
+
+uint32_t SystemClock::elapsed_us(uint32_t since) {
+    return micros() - since;
+}
+
+// Returns true once per interval and advances since by the interval, so
+// periodic work does not drift. If more than a full interval was missed the
+// schedule restarts from now instead of catching up in a burst.
+bool SystemClock::has_elapsed(uint32_t &since, uint32_t interval) {
+    uint32_t now = millis();
+    if (now - since < interval) return false;
+
+    since += interval;
+    if (now - since >= interval) since = now;
+    return true;
+}
+
+//==============================================================================
+// Public Methods: attach, detach
+// Description: Run a callback from the tick ISR every millisecond, for work
+//              that has to keep time even while the main loop is blocked.
+//              The callback must be short; interrupts are disabled while it
+//              runs. Only one callback is supported, attach replaces it.
+//              detach(on_tick) only removes on_tick, so a driver cannot
+//              remove a callback that replaced its own.
+//==============================================================================
+void SystemClock::attach(Callback on_tick) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _on_tick = on_tick;
+    }
+}
+
+void SystemClock::detach() {
+    attach(nullptr);
+}
+
+void SystemClock::detach(Callback on_tick) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (_on_tick == on_tick) _on_tick = nullptr;
+    }
+}
\ No newline at end of file
@@ -47,48 +47,83 @@
          (pin) == 4 ?  PORTC4 : \
          (pin) == 5 ?  PORTC5 : 0) : 0)
 
+// Macro to obtain a pointer to the appropriate PIN register for a given pin
 #define PIN_FOR_PIN(pinType, pin) \
-    ((pinType) == GPIO::DIGITAL_PIN ? (pin < 8 ? &PIND : \
-    (pin < 16 ? &PINB : &PINC)) : nullptr)
+    ((pinType) == GPIO::DIGITAL_PIN ? \
+        ((pin) <= 7 ? &PIND : \
+         (pin) >= 8 && (pin) <= 13 ? &PINB : nullptr) : \
+     (pinType) == GPIO::ANALOG_PIN ? \
+        ((pin) <= 5 ? &PINC : nullptr) : nullptr)
 
 //==============================================================================
 // GPIO Constructor
+// Description: Resolve the registers and bit mask once, so the accessors do
+//              not evaluate the lookup macros on every call. Invalid pins
+//              get the DDR/PORT/PIN of a valid port and an empty mask, so
+//              every access is a no-op.
 //==============================================================================
 GPIO::GPIO(PinType pin_type, uint8_t pin) 
-    : _pin_type(pin_type), _pin(pin) {}
+    : _ddr(DDR_FOR_PIN(pin_type, pin)), 
+      _port(PORT_FOR_PIN(pin_type, pin)),
+      _in(PIN_FOR_PIN(pin_type, pin)),
+      _mask(1 << BIT_FOR_PIN(pin_type, pin)) {
+    if (!_ddr || !_port || !_in) {
+        _ddr = &DDRB;
+        _port = &PORTB;
+        _in = &PINB;
+        _mask = 0;
+    }
+}
 
 //==============================================================================
 // GPIO Public Methods: enable_output, enable_input, set_high, set_low,
 //                      toggle, is_high, is_low
 //==============================================================================
 void GPIO::enable_output() {
-    (*(DDR_FOR_PIN(_pin_type, _pin))) |= (1 << BIT_FOR_PIN(_pin_type, _pin));
+    *_ddr |= _mask;
 }
 
 void GPIO::enable_input() {
-    (*(DDR_FOR_PIN(_pin_type, _pin))) &= ~(1 << BIT_FOR_PIN(_pin_type, _pin));
+    *_ddr &= ~_mask;
 }
 
 void GPIO::enable_pullup() {
-    (*(PORT_FOR_PIN(_pin_type, _pin))) |= (1 << BIT_FOR_PIN(_pin_type, _pin));
+    *_port |= _mask;
 }
 
 void GPIO::set_high() {
-    (*(PORT_FOR_PIN(_pin_type, _pin))) |= (1 << BIT_FOR_PIN(_pin_type, _pin));
+    *_port |= _mask;
 }
 
 void GPIO::set_low() {
-    (*(PORT_FOR_PIN(_pin_type, _pin))) &= ~(1 << BIT_FOR_PIN(_pin_type, _pin));
+    *_port &= ~_mask;
 }
 
 void GPIO::toggle() {
-    (*(PORT_FOR_PIN(_pin_type, _pin))) ^= (1 << BIT_FOR_PIN(_pin_type, _pin));
+    *_in = _mask; // Writing 1 to PINx toggles the output bit
 }
 
 bool GPIO::is_high() {
-    return (*(PIN_FOR_PIN(_pin_type, _pin)) & (1 << BIT_FOR_PIN(_pin_type, _pin)));
+    return (*_in & _mask);
 }
 
 bool GPIO::is_low() {
-    return !(*(PIN_FOR_PIN(_pin_type, _pin)) & (1 << BIT_FOR_PIN(_pin_type, _pin)));
+    return !(*_in & _mask);
+}
+
+//==============================================================================
+// GPIO Public Methods: port_register, pin_register, bit_mask
+// Description: Expose the resolved registers, so time critical code (ISRs)
+//              can access the pin directly.
+//==============================================================================
+volatile uint8_t* GPIO::port_register() {
+    return _port;
+}
+
+volatile uint8_t* GPIO::pin_register() {
+    return _in;
+}
+
+uint8_t GPIO::bit_mask() {
+    return _mask;
 }
\ No newline at end of file
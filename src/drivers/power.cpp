@@ -0,0 +1,75 @@
+//==============================================================================
+// Power (Idle Sleep and CPU Load) Implementation
+//==============================================================================
+#include "drivers/power.h"
+#include "drivers/soft_timer.h"
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+// Static Members definitions
+uint32_t Power::_window_start = 0;
+uint32_t Power::_sleep_us = 0;
+uint16_t Power::_wakeups = 0;
+Power::LoadStats Power::_last = { 0, 0, 0 };
+
+//==============================================================================
+// Public Method: init
+// Description: Turn off the peripherals this firmware never uses (TWI, SPI
+//              and the analog comparator). Deeper sleep modes than IDLE
+//              would stop timer 0 and with it the SystemClock, so the
+//              savings come from clock gating the unused modules instead.
+//==============================================================================
+void Power::init() {
+    ACSR |= (1 << ACD);                   // Analog comparator off
+    PRR  |= (1 << PRTWI) | (1 << PRSPI);  // TWI and SPI clocks off
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    _window_start = SystemClock::micros();
+}
+
+//==============================================================================
+// Public Method: idle
+// Description: Sleep until the next interrupt unless a soft timer is already
+//              due or busy() (optional) reports work queued by an ISR, such
+//              as a received line. Call it at the end of the main loop when
+//              no other work is pending. The checks and the sleep run with
+//              interrupts disabled (sei() delays them by one instruction), so
+//              a wakeup cannot be lost between them. Time spent in ISRs while
+//              asleep counts as sleep time.
+//==============================================================================
+void Power::idle(bool (*busy)()) {
+    uint32_t now = SystemClock::micros();
+    uint32_t window = now - _window_start;
+
+    // Close the load window
+    if (window >= LOAD_WINDOW_MS * 1000UL) {
+        uint32_t sleep_permille = _sleep_us / (window / 1000);
+        _last.load    = sleep_permille >= 1000 ? 0 : 1000 - sleep_permille;
+        _last.wakeups = _wakeups;
+        _last.window  = window / 1000;
+        _window_start = now;
+        _sleep_us = 0;
+        _wakeups  = 0;
+    }
+
+    cli();
+    if (TimerWheel::pending() || (busy && busy())) {
+        sei();
+        return;
+    }
+
+    uint32_t start = SystemClock::micros(); // Interrupts stay disabled
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+
+    _sleep_us += SystemClock::micros() - start;
+    _wakeups++;
+}
+
+//==============================================================================
+// Public Method: load_stats
+//==============================================================================
+void Power::load_stats(LoadStats &stats) {
+    stats = _last;
+}
\ No newline at end of file
@@ -2,6 +2,9 @@
 // PWM Interface Class Implementation
 //==============================================================================
 #include "drivers/pwm.h"
+#include "drivers/timer_resource.h"
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
 
 //==============================================================================
 // PWM Configuration Macros
@@ -13,48 +16,97 @@
 
 #define CONFIGURE_PWM_DDR(ddr, port) ((ddr) |= (1 << (port)))
 
-#define CONFIGURE_PWM(ddr, port, ocr, com, wgm0, wgm1, cs) \
-    ddr |= (1 << port),                      /* Set pin as output */ \
-    TCCR##ocr##A |= (1 << com) | (1 << wgm0), /* Setup PWM mode */ \
-    TCCR##ocr##B |= (1 << cs)  | (1 << wgm1)  /* Setup prescaler and additional mode bits */
+#define PWM_WGM_A_MASK(n) ((1 << WGM##n##1) | (1 << WGM##n##0))
+#define PWM_CS_MASK(n)    ((1 << CS##n##2) | (1 << CS##n##1) | (1 << CS##n##0))
+
+// Fast 8-bit PWM, non-inverting output. The mode and prescaler bits are
+// cleared first, only the pin's own output mode is touched so a second PWM
+// channel on the same timer keeps running.
+#define CONFIGURE_PWM(ddr, port, n, com1, com0, wgm_a, wgm_b, wgm_b_mask, cs) \
+    ddr |= (1 << port),                       /* Set pin as output */ \
+    TCCR##n##A = (TCCR##n##A & ~(PWM_WGM_A_MASK(n) | (1 << com0))) \
+                 | (1 << com1) | (wgm_a),     /* Setup PWM mode */ \
+    TCCR##n##B = (TCCR##n##B & ~((wgm_b_mask) | PWM_CS_MASK(n))) \
+                 | (wgm_b) | (1 << cs)        /* Setup prescaler and additional mode bits */
 
 #define SETUP_PWM_FOR_PIN(pin) \
-    if      ((pin) == 3)  { CONFIGURE_PWM(DDRD, PORTD3, 2, COM2B1, WGM20, WGM21, CS21); } \
-    else if ((pin) == 5)  { CONFIGURE_PWM(DDRD, PORTD5, 0, COM0B1, WGM00, WGM01, CS01); } \
-    else if ((pin) == 6)  { CONFIGURE_PWM(DDRD, PORTD6, 0, COM0A1, WGM00, WGM01, CS01); } \
-    else if ((pin) == 9)  { CONFIGURE_PWM(DDRB, PORTB1, 1, COM1A1, WGM10, WGM11, CS11); } \
-    else if ((pin) == 10) { CONFIGURE_PWM(DDRB, PORTB2, 1, COM1B1, WGM10, WGM11, CS11); } \
-    else if ((pin) == 11) { CONFIGURE_PWM(DDRB, PORTB3, 2, COM2A1, WGM20, WGM21, CS21); }
+    if      ((pin) == 3)  { CONFIGURE_PWM(DDRD, PORTD3, 2, COM2B1, COM2B0, (1 << WGM21) | (1 << WGM20), 0, (1 << WGM22), CS21); } \
+    else if ((pin) == 5)  { CONFIGURE_PWM(DDRD, PORTD5, 0, COM0B1, COM0B0, (1 << WGM01) | (1 << WGM00), 0, (1 << WGM02), CS01); } \
+    else if ((pin) == 6)  { CONFIGURE_PWM(DDRD, PORTD6, 0, COM0A1, COM0A0, (1 << WGM01) | (1 << WGM00), 0, (1 << WGM02), CS01); } \
+    else if ((pin) == 9)  { CONFIGURE_PWM(DDRB, PORTB1, 1, COM1A1, COM1A0, (1 << WGM10), (1 << WGM12), (1 << WGM13) | (1 << WGM12), CS11); } \
+    else if ((pin) == 10) { CONFIGURE_PWM(DDRB, PORTB2, 1, COM1B1, COM1B0, (1 << WGM10), (1 << WGM12), (1 << WGM13) | (1 << WGM12), CS11); } \
+    else if ((pin) == 11) { CONFIGURE_PWM(DDRB, PORTB3, 2, COM2A1, COM2A0, (1 << WGM21) | (1 << WGM20), 0, (1 << WGM22), CS21); }
+
+//==============================================================================
+// Gamma Table
+// Description: Perceived brightness to duty cycle, duty = 255 * (i/255)^2.2,
+//              so a linear ramp of the index looks linear to the eye.
+//==============================================================================
+static const uint8_t gamma_table[256] PROGMEM = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+     42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+     91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255,
+};
+
+// Static Members definitions
+PWModulation* volatile PWModulation::_ramp_pwm = nullptr;
 
 //==============================================================================
 // Constructor
+// Description:   The registers are only resolved by init() once the timer is
+//                claimed, so an unclaimed output never writes them.
 //==============================================================================
-PWModulation::PWModulation(const uint8_t &pwm_pin) : _pin(pwm_pin) {
-    if (_valid_pwm_pin(_pin)) {
-        // Assign the correct output compare register based on the PWM pin
-        switch (pwm_pin) {
-            // Assign to _ocr8 or _ocr16 depending on the timer resolution
-            case 3:  _ocr8  = &OCR2B; break;             // 8-bit
-            case 5:  _ocr8  = &OCR0B; break;             // 8-bit
-            case 6:  _ocr8  = &OCR0A; break;             // 8-bit
-            case 9:  _ocr16 = (uint16_t*)&OCR1A; break;  // 16-bit
-            case 10: _ocr16 = (uint16_t*)&OCR1B; break;  // 16-bit
-            case 11: _ocr8  = &OCR2A; break;             // 8-bit
-        }
-    }
+PWModulation::PWModulation(const uint8_t &pwm_pin) 
+    : _pin(pwm_pin), _ocr16(nullptr), _ocr8(nullptr), _tccr(nullptr), 
+      _com_mask(0), _cycle_time(0), _phase(0), _phase_step(0) {
 }
 
 //==============================================================================
 // Public Method: init, reset
-// Description:   configure the PWM output pin and set the initial duty cycle
+// Description:   configure the PWM output pin and set the initial duty cycle.
+//                Fails if the pin's timer is owned by another driver (timer 0
+//                is always taken by the SystemClock tick).
 //==============================================================================
 bool PWModulation::init() {
-    if (_valid_pwm_pin(_pin)) {
+    if (_valid_pwm_pin(_pin) &&
+        TimerResource::claim(TimerResource::pwm_timer(_pin), 
+                             TimerResource::PWM_8BIT,
+                             TimerResource::pwm_channel(_pin))) {
         SETUP_PWM_FOR_PIN(_pin);   // Register bits defined in pwm.h
+
+        // Output compare register and output mode bit of the pin, only
+        // touched once the timer is ours (_ocr8 or _ocr16 by resolution)
+        switch (_pin) {
+            case 3:  _ocr8  = &OCR2B;
+                     _tccr = &TCCR2A; _com_mask = (1 << COM2B1); break;
+            case 5:  _ocr8  = &OCR0B;
+                     _tccr = &TCCR0A; _com_mask = (1 << COM0B1); break;
+            case 6:  _ocr8  = &OCR0A;
+                     _tccr = &TCCR0A; _com_mask = (1 << COM0A1); break;
+            case 9:  _ocr16 = (uint16_t*)&OCR1A;
+                     _tccr = &TCCR1A; _com_mask = (1 << COM1A1); break;
+            case 10: _ocr16 = (uint16_t*)&OCR1B;
+                     _tccr = &TCCR1A; _com_mask = (1 << COM1B1); break;
+            case 11: _ocr8  = &OCR2A;
+                     _tccr = &TCCR2A; _com_mask = (1 << COM2A1); break;
+        }
         reset();                   // Set the initial duty cycle
         return true;   // Valid pin
     } else {
-        return false; // Invalid pin
+        return false; // Invalid pin or timer in use
     }
 }
 
@@ -66,55 +118,98 @@ void PWModulation::reset() {
 // Public Method: setDutyCycle
 // Description:   Set the duty cycle of the PWM signal. The duty cycle is
 //                a value between 0 and 255, where 0 is 0% and 255 is 100%.
+//                Fast PWM still outputs a 1 count spike at OCR = 0, so zero
+//                duty disconnects the output (the pin is driven low by its
+//                PORT bit) instead, as PWM16 does.
 //==============================================================================
 void PWModulation::set_duty_cycle(uint8_t duty) {
     _duty_cycle = duty; // Just store duty cycle value
     if (_ocr8) {
         *_ocr8 = (uint8_t)(duty & 0xFF);  // 8-bit OCR, cast to ensure no overflow
-    } else {
+    } else if (_ocr16) {
         *_ocr16 = duty; // Update 16-bit OCR
     } 
+
+    // TCCRnA is shared with the other channel of the timer
+    if (_tccr) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (duty) *_tccr |= _com_mask;
+            else      *_tccr &= ~_com_mask;
+        }
+    }
+}
+
+//==============================================================================
+// Phase increment per tick for a 2^32 cycle, rounded to nearest. Works from
+// 2^32 - 1 so it stays in 32-bit arithmetic.
+//==============================================================================
+static constexpr uint32_t _ramp_phase_step(uint16_t cycle_time) {
+    const uint32_t q = UINT32_MAX / cycle_time;
+    const uint32_t r = UINT32_MAX % cycle_time + 1; // 2^32 = q * cycle + r
+    return q + (2 * r >= cycle_time ? 1 : 0);
 }
 
 //==============================================================================
-// Public Method: rampOutput
+// Public Method: rampOutput, stop_ramp
 // Description:   Ramp the PWM output up and down over a specified cycle time.
-//                If you pass a cycle time of 1000ms and a millis timer, the
-//                duty cycle will ramp up and down once every second.
-//==============================================================================
-void PWModulation::ramp_output(const uint16_t &cycle_time, Timer &timer) {
-    // Ensure cycle_time is large enough to avoid division by zero
-    if (cycle_time < 2 * UINT8_MAX) return;
-
-    // Calculate the increase in overflow since last update
-    uint16_t overflow_increase = timer.overflow_counter - _last_overflow_count;
-    _overflow_counter += overflow_increase;
-
-    // Update _last_overflow_count to the current timer.overflow_counter
-    _last_overflow_count = timer.overflow_counter;
-
-    // Calculate the number of timer overflows required for a single step
-    uint16_t steps = (cycle_time / (UINT8_MAX * 2)) * 2; // *2 ramps per cycle
-
-    if (_overflow_counter >= steps) {
-        if (_ramp_up) {
-            if (_duty_cycle < UINT8_MAX) {
-                _duty_cycle++;
-            } else {
-                _ramp_up = false;
-            }
-        } else {
-            if (_duty_cycle > 0) {
-                _duty_cycle--;
-            } else {
-                _ramp_up = true;
-            }
-        }
+//                If you pass a cycle time of 1000ms the duty cycle will ramp
+//                up and down once every second. The ramp runs from the
+//                SystemClock tick ISR, so calling this again with the same
+//                cycle time does nothing and a blocked main loop does not
+//                stall it. A new cycle time keeps the current position.
+//==============================================================================
+void PWModulation::ramp_output(const uint16_t &cycle_time) {
+    // Need at least two ticks per cycle to move at all
+    if (cycle_time < 2) return;
+    if (cycle_time == _cycle_time && _ramp_pwm == this) return;
+
+    uint32_t phase_step = _ramp_phase_step(cycle_time);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (_ramp_pwm != this) _phase = 0; // Start dark
+        _cycle_time = cycle_time;
+        _phase_step = phase_step;
+        _ramp_pwm = this;
+    }
+    SystemClock::attach(handle_ramp_tick);
+}
+
+void PWModulation::stop_ramp() {
+    if (_ramp_pwm != this) return;
+    SystemClock::detach(handle_ramp_tick);
+    _ramp_pwm = nullptr;
+    _cycle_time = 0;
+}
+
+//==============================================================================
+// Static Method: handle_ramp_tick
+// Description:   Advance the phase accumulator by one tick. The top 9 bits
+//                of the phase are the position on a 512-step triangle (up
+//                then down), which indexes the gamma table.
+//==============================================================================
+void PWModulation::handle_ramp_tick() {
+    PWModulation* pwm = _ramp_pwm;
+    if (!pwm) return;
+
+    pwm->_phase += pwm->_phase_step;
+    uint16_t pos = pwm->_phase >> 23;
+    uint8_t level = pos <= UINT8_MAX ? pos : 2 * UINT8_MAX + 1 - pos;
+    pwm->set_duty_cycle(pgm_read_byte(&gamma_table[level]));
+}
 
-        set_duty_cycle(_duty_cycle);
-        _overflow_counter = 0; // Reset the overflow counter
+// Compile-time check that the rounded phase increment keeps every valid ramp
+// cycle time (2-5000ms) within a tick of exact over a full cycle
+constexpr bool _phase_step_is_tick_accurate() {
+    for (uint16_t cycle_time = 2; cycle_time <= 5000; cycle_time++) {
+        const uint64_t cycle = (uint64_t)1 << 32;
+        const uint64_t step = _ramp_phase_step(cycle_time);
+        const uint64_t total = step * cycle_time;
+        const uint64_t error = total > cycle ? total - cycle : cycle - total;
+        if (error >= step) return false;
     }
+    return true;
 }
+static_assert(_phase_step_is_tick_accurate(), "Ramp phase step drifts a tick");
 
 //==============================================================================
 // Constexpr validation for PWM pins
@@ -0,0 +1,159 @@
+//==============================================================================
+// Timer 1 16-bit PWM Implementation
+//==============================================================================
+#include "drivers/pwm16.h"
+#include "drivers/timer_resource.h"
+#include <util/atomic.h>
+
+// Static Members definitions
+PWM16::Mode PWM16::_mode = PWM16::FAST;
+uint8_t PWM16::_outputs = 0;
+uint16_t PWM16::_staged_duty[2] = { 0, 0 };
+uint16_t PWM16::_staged_top = 0;
+volatile uint16_t PWM16::_latch_duty[2] = { 0, 0 };
+volatile uint16_t PWM16::_latch_top = 0;
+volatile bool PWM16::_pending = false;
+volatile uint8_t PWM16::_com = 0;
+volatile bool PWM16::_com_pending = false;
+
+// Waveform generation bits for each mode, all with ICR1 as TOP
+#define PWM16_TCCR1A_BITS(mode) ((mode) == PWM16::PHASE_FREQ_CORRECT ? 0 \
+                                                                      : (1 << WGM11))
+#define PWM16_TCCR1B_BITS(mode) ((mode) == PWM16::FAST ? ((1 << WGM13) | (1 << WGM12)) \
+                                                        : (1 << WGM13))
+
+//==============================================================================
+// Public Method: init
+// Description: Stop timer 1 and restart it in the PWM mode with both duty
+//              cycles at 0. Returns false for invalid settings or if timer 1
+//              is owned by another driver (capture, the button counter).
+//==============================================================================
+bool PWM16::init(Mode mode, const Settings &settings, uint8_t outputs) {
+    if (settings.prescaler == 0 || settings.top < MIN_TOP ||
+        TIMER1_PS_BITS(settings.prescaler) == 0 ||
+        !TimerResource::claim(Timer::TIMER1, TimerResource::PWM_16BIT,
+                              TimerResource::CHANNEL_ALL)) {
+        return false;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TCCR1B = 0; // Stop the counter
+        TIMSK1 &= ~((1 << ICIE1) | (1 << OCIE1A) | (1 << OCIE1B) | (1 << TOIE1));
+
+        _mode = mode;
+        _outputs = outputs & (OUTPUT_A | OUTPUT_B);
+        _staged_duty[CH_A] = _staged_duty[CH_B] = 0;
+        _staged_top = settings.top;
+        _pending = false;
+        _com = 0;
+        _com_pending = false;
+
+        ICR1  = settings.top;
+        OCR1A = 0;
+        OCR1B = 0;
+        TCNT1 = 0;
+        PORTB &= ~((1 << PORTB1) | (1 << PORTB2));
+        if (_outputs & OUTPUT_A) DDRB |= (1 << DDB1);
+        if (_outputs & OUTPUT_B) DDRB |= (1 << DDB2);
+
+        // Outputs stay disconnected (low) until a non-zero duty is latched
+        TCCR1A = PWM16_TCCR1A_BITS(mode);
+        TCCR1B = PWM16_TCCR1B_BITS(mode) | TIMER1_PS_BITS(settings.prescaler);
+    }
+    Timer::timer_1.attach_overflow(handle_overflow);
+    return true;
+}
+
+//==============================================================================
+// Public Method: stop
+// Description: Stop timer 1, disconnect the outputs (driven low) and release
+//              the timer. Does nothing if PWM16 does not own timer 1.
+//==============================================================================
+void PWM16::stop() {
+    if (TimerResource::owner(Timer::TIMER1) != TimerResource::PWM_16BIT) return;
+
+    _pending = false;
+    _com_pending = false;
+    TimerResource::release(Timer::TIMER1, TimerResource::PWM_16BIT);
+    Timer::timer_1.attach_overflow(nullptr);
+}
+
+//==============================================================================
+// Public Methods: set_duty, set_top, commit, pending, top
+// Description: set_duty() and set_top() only stage the new values, commit()
+//              hands all of them to the overflow ISR at once. A commit that
+//              has not been latched yet is replaced by the next one. Duty
+//              is clamped to TOP (always on); 0 is always off.
+//==============================================================================
+void PWM16::set_duty(Channel ch, uint16_t duty) {
+    _staged_duty[ch] = duty;
+}
+
+void PWM16::set_top(uint16_t top) {
+    if (top >= MIN_TOP) _staged_top = top;
+}
+
+void PWM16::commit() {
+    uint16_t top = _staged_top;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _latch_duty[CH_A] = _staged_duty[CH_A] < top ? _staged_duty[CH_A] : top;
+        _latch_duty[CH_B] = _staged_duty[CH_B] < top ? _staged_duty[CH_B] : top;
+        _latch_top = top;
+        _pending = true;
+
+        // Latch right after the next overflow, not on a stale flag
+        TIFR1 = (1 << TOV1);
+        TIMSK1 |= (1 << TOIE1);
+    }
+}
+
+bool PWM16::pending() {
+    return _pending || _com_pending;
+}
+
+uint16_t PWM16::top() {
+    return _staged_top;
+}
+
+//==============================================================================
+// Static Method: handle_overflow
+// Description: TOV1 is set at TOP in fast PWM and at BOTTOM in the dual slope
+//              modes, so the ISR runs at least half a period before the
+//              OCR1x buffers are next updated and both channels take effect
+//              together. ICR1 is not buffered and by the time it is written
+//              the counter has run on from BOTTOM by the interrupt latency
+//              (tens of counts at /1). If that already passed a smaller new
+//              TOP the counter would run on to 0xFFFF, so it is restarted at
+//              BOTTOM instead, which costs at most a short period.
+//              Fast PWM still outputs a 1 count spike at OCR1x = 0, so zero
+//              duty disconnects the output instead. The COM bits are not
+//              buffered: an output is only disconnected on the following
+//              overflow, once its OCR1x = 0 has been loaded, so its last
+//              pulse is not cut short. An output is connected at once, its
+//              buffered OCR1x is still 0 and keeps it low until the new duty
+//              is loaded.
+//==============================================================================
+void PWM16::handle_overflow() {
+    if (!_pending) {
+        // OCR1x of the last commit are loaded, drop the outputs now at 0
+        TCCR1A = PWM16_TCCR1A_BITS(_mode) | _com;
+        _com_pending = false;
+        TIMSK1 &= ~(1 << TOIE1);
+        return;
+    }
+
+    uint8_t com = 0;
+    if ((_outputs & OUTPUT_A) && _latch_duty[CH_A]) com |= (1 << COM1A1);
+    if ((_outputs & OUTPUT_B) && _latch_duty[CH_B]) com |= (1 << COM1B1);
+
+    ICR1   = _latch_top;
+    if (TCNT1 >= _latch_top) TCNT1 = 0; // Counter already passed the new TOP
+    OCR1A  = _latch_duty[CH_A];
+    OCR1B  = _latch_duty[CH_B];
+    TCCR1A |= com;
+
+    _com = com;
+    _com_pending = true;
+    _pending = false; // TOIE1 stays on for the COM update
+}
\ No newline at end of file
@@ -2,67 +2,298 @@
 // Serial Driver Class Implementation
 //==============================================================================
 #include "drivers/serial.h"
-#include <stdio.h>
+#include <stdarg.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+
+// Shorthands for the SerialPort member definitions
+#define SERIAL_TEMPLATE template <uint8_t rx_size, uint8_t tx_size>
+#define SERIAL_PORT SerialPort<rx_size, tx_size>
 
 // Static Members definitions
-constexpr uint8_t Serial::buf_size;
-volatile char Serial::uart_buffer[Serial::buf_size];
-volatile uint8_t Serial::uart_next_pos = 0;
-volatile uint8_t Serial::uart_read_pos = 0;
-volatile uint8_t Serial::uart_write_pos = 0;
-volatile bool Serial::uart_command_ready = false;
-volatile bool Serial::uart_buffer_overflow = false;
+SERIAL_TEMPLATE volatile char SERIAL_PORT::uart_buffer[SERIAL_PORT::buf_size];
+SERIAL_TEMPLATE volatile uint8_t SERIAL_PORT::uart_read_pos = 0;
+SERIAL_TEMPLATE volatile uint8_t SERIAL_PORT::uart_write_pos = 0;
+SERIAL_TEMPLATE volatile bool SERIAL_PORT::uart_buffer_overflow = false;
+SERIAL_TEMPLATE volatile typename SERIAL_PORT::LineDesc 
+    SERIAL_PORT::uart_lines[SERIAL_PORT::line_queue_size];
+SERIAL_TEMPLATE volatile uint8_t SERIAL_PORT::uart_line_head = 0;
+SERIAL_TEMPLATE volatile uint8_t SERIAL_PORT::uart_line_tail = 0;
+SERIAL_TEMPLATE volatile uint8_t SERIAL_PORT::uart_line_count = 0;
+SERIAL_TEMPLATE volatile uint8_t SERIAL_PORT::uart_line_start = 0;
+SERIAL_TEMPLATE uint8_t SERIAL_PORT::uart_line_cursor = 0;
+SERIAL_TEMPLATE volatile bool SERIAL_PORT::uart_rx_frame = false;
+SERIAL_TEMPLATE volatile uint16_t SERIAL_PORT::uart_frame_errors = 0;
+SERIAL_TEMPLATE volatile char SERIAL_PORT::uart_tx_buffer[SERIAL_PORT::tx_buf_size];
+SERIAL_TEMPLATE volatile uint8_t SERIAL_PORT::uart_tx_read_pos = 0;
+SERIAL_TEMPLATE volatile uint8_t SERIAL_PORT::uart_tx_write_pos = 0;
+SERIAL_TEMPLATE volatile uint16_t SERIAL_PORT::uart_tx_dropped = 0;
+SERIAL_TEMPLATE volatile uint8_t SERIAL_PORT::uart_flow = SERIAL_PORT::FLOW_NONE;
+SERIAL_TEMPLATE volatile bool SERIAL_PORT::uart_rx_throttled = false;
+SERIAL_TEMPLATE volatile bool SERIAL_PORT::uart_tx_paused = false;
+SERIAL_TEMPLATE volatile char SERIAL_PORT::uart_flow_char = 0;
+SERIAL_TEMPLATE volatile uint8_t* SERIAL_PORT::uart_rts_port = nullptr;
+SERIAL_TEMPLATE volatile uint8_t* SERIAL_PORT::uart_cts_pin = nullptr;
+SERIAL_TEMPLATE uint8_t SERIAL_PORT::uart_rts_mask = 0;
+SERIAL_TEMPLATE uint8_t SERIAL_PORT::uart_cts_mask = 0;
+SERIAL_TEMPLATE volatile uint16_t SERIAL_PORT::uart_framing_errors = 0;
+SERIAL_TEMPLATE volatile uint16_t SERIAL_PORT::uart_overrun_errors = 0;
+SERIAL_TEMPLATE volatile uint16_t SERIAL_PORT::uart_parity_errors = 0;
+SERIAL_TEMPLATE volatile uint16_t SERIAL_PORT::uart_ring_overflows = 0;
+
+//==============================================================================
+// Interrupt Service Routines for CTS pin changes
+// Description: CTS pin changes (digital pins 0-7 and 8-13) resume a paused
+//              transmitter. Only built with SERIAL_FLOW_RTSCTS, so the vectors
+//              stay free otherwise. The RX and UDRE ISRs follow their
+//              handlers below.
+//==============================================================================
+#if SERIAL_FLOW_RTSCTS
+ISR(PCINT0_vect) {
+    Serial::handle_cts_interrupt();
+}
+
+ISR(PCINT2_vect) {
+    Serial::handle_cts_interrupt();
+}
+#endif
+
+//==============================================================================
+// Private Method: _set_rx_throttle
+// Description: Asks the sender to pause (throttle) or resume, by driving RTS
+//              or by queueing XOFF/XON ahead of the TX buffer. Called with
+//              interrupts disabled.
+//==============================================================================
+SERIAL_TEMPLATE
+void SERIAL_PORT::_set_rx_throttle(bool throttle) {
+    uart_rx_throttled = throttle;
+
+    if (uart_flow == FLOW_RTSCTS) {
+        if (throttle) *uart_rts_port |= uart_rts_mask;  // Deassert RTS
+        else          *uart_rts_port &= ~uart_rts_mask; // Assert RTS
+    } else if (uart_flow == FLOW_XONXOFF) {
+        uart_flow_char = throttle ? XOFF : XON;
+        ENABLE_UART_UDRE_INTERRUPT();
+    }
+}
 
 //==============================================================================
-// Interrupt Service Routine for UART receive
+// Static Method: handle_rx_interrupt
+// Description: Stores received characters in the circular buffer and queues
+//              a descriptor for every complete line, so several commands can
+//              be pending at once. A text line ends with '\n'. A binary
+//              frame starts with a 0x00 byte and ends with the next 0x00
+//              (COBS encoded, so the frame itself never contains a zero).
+//              Frame mode also ends after frame_encoded_max bytes or on a
+//              buffer overflow, so a stray zero cannot hide text commands.
+//              The volatile state is read once into locals to keep the ISR
+//              short. Line errors are counted from UCSR0A. With flow control
+//              the sender is paused once the buffer fills past the high
+//              watermark or a single line descriptor is left. A line that
+//              alone reaches the high watermark could never be released to
+//              make room, so it is dropped as an overflowed line instead.
 //==============================================================================
-ISR(USART_RX_vect) {    
+SERIAL_TEMPLATE
+void SERIAL_PORT::handle_rx_interrupt() {
+    uint8_t status = UCSR0A; // Error flags are only valid before reading UDR0
     char rec_char = UART_DATA_REGISTER;
-    Serial::uart_next_pos = (Serial::uart_write_pos + 1) % Serial::buf_size;
+    bool frame = uart_rx_frame;
+
+    if (status & ((1 << FE0) | (1 << DOR0) | (1 << UPE0))) {
+        if (status & (1 << DOR0)) uart_overrun_errors++;
+        if (status & (1 << FE0))  uart_framing_errors++;
+        if (status & (1 << UPE0)) uart_parity_errors++;
+
+        // Drop corrupted characters (an overrun only lost earlier ones)
+        if (status & ((1 << FE0) | (1 << UPE0))) return;
+    }
+
+    // Software flow control from the host (text mode only)
+    if (uart_flow == FLOW_XONXOFF && !frame && 
+        (rec_char == XON || rec_char == XOFF)) {
+        uart_tx_paused = (rec_char == XOFF);
+        if (rec_char == XON) ENABLE_UART_UDRE_INTERRUPT();
+        return;
+    }
+
+    bool overflow = uart_buffer_overflow;
+    uint8_t write_pos = uart_write_pos;
+    uint8_t line_start = uart_line_start;
 
-    // Check for string terminator to set command ready flag
-    if (rec_char == '\n') {
-        Serial::uart_command_ready = true;
+    // Zero byte outside a frame: start of a binary frame
+    if (rec_char == 0 && !frame) {
+        uart_write_pos = line_start; // drop partial text
+        uart_buffer_overflow = false;
+        uart_rx_frame = true;
+        return;
     }
 
+    // A frame that overflowed the buffer or grew past the longest valid
+    // encoding is ended as an overflowed frame (NAKed by the reader), so a
+    // stray zero byte cannot keep swallowing the following text lines
+    uint8_t length = (write_pos - line_start) & rx_mask;
+    bool runaway = frame && rec_char != 0 &&
+                   (overflow || length >= frame_encoded_max);
+
+    // End of line/frame: queue a descriptor pointing at it in the buffer
+    if (runaway || (rec_char == '\n' && !frame) || (rec_char == 0 && frame)) {
+        if (runaway) {
+            write_pos = line_start; // drop the partial frame
+            uart_write_pos = write_pos;
+            length = 0;
+            overflow = true;
+        }
+
+        // Back-to-back zeros are idle delimiters, wait for the frame data
+        if (frame && length == 0 && !overflow) return;
+
+        uint8_t count = uart_line_count;
+        if (count < line_queue_size) {
+            uint8_t tail = uart_line_tail;
+            volatile LineDesc& line = uart_lines[tail];
+            line.start    = line_start;
+            line.length   = length;
+            line.overflow = overflow;
+            line.frame    = frame;
+            uart_line_tail  = (tail + 1) & line_mask;
+            uart_line_count = count + 1;
+            uart_line_start = write_pos;
+
+            // Pause the sender while it can still fit the last descriptor
+            if (uart_flow != FLOW_NONE && !uart_rx_throttled &&
+                count + 1 >= line_queue_size - 1) {
+                _set_rx_throttle(true);
+            }
+        } else {
+            // No free descriptor - drop the line to keep the buffer in sync
+            uart_write_pos = line_start;
+            uart_ring_overflows++;
+        }
+
+        uart_buffer_overflow = false;
+        uart_rx_frame = false;
+        return;
+    }
+
+    // Discard the rest of a line that did not fit in the buffer
+    if (overflow) return;
+
+    uint8_t next_pos = (write_pos + 1) & rx_mask;
+
     // Check for buffer overflow (if no overflow, write to buffer)
-    if (Serial::uart_next_pos != Serial::uart_read_pos) {
-        Serial::uart_buffer_overflow = false;
-        Serial::uart_buffer[Serial::uart_write_pos] = rec_char;
-        Serial::uart_write_pos = Serial::uart_next_pos;
+    uint8_t read_pos = uart_read_pos;
+    if (next_pos != read_pos) {
+        uart_buffer[write_pos] = rec_char;
+        uart_write_pos = next_pos;
+
+        // Pause the sender when the buffer is filling up
+        if (uart_flow != FLOW_NONE &&
+            ((next_pos - read_pos) & rx_mask) >= rx_high_water) {
+            if (((next_pos - line_start) & rx_mask) >= rx_high_water) {
+                // Too long to ever be released: drop it, and resume the
+                // sender if no other line will be released to do it
+                uart_write_pos = line_start;
+                uart_buffer_overflow = true;
+                uart_ring_overflows++;
+                if (uart_rx_throttled && uart_line_count == 0) {
+                    _set_rx_throttle(false);
+                }
+            } else if (!uart_rx_throttled) {
+                _set_rx_throttle(true);
+            }
+        }
     } else {
-        Serial::uart_buffer_overflow = true;
-        // Buffer is full/overflowed - Error is handled in read method!
+        // Buffer is full - drop the partial line, the error is reported to
+        // the reader once its newline arrives
+        uart_write_pos = line_start;
+        uart_buffer_overflow = true;
+        uart_ring_overflows++;
     }
 }
 
 //==============================================================================
-// Constructor: Serial
+// Static Method: handle_udre_interrupt
+// Description: Sends the next byte from the TX buffer and disables the
+//              interrupt once the buffer has been drained. A pending XON/XOFF
+//              goes out first, and nothing is sent while the host has paused
+//              us (XOFF received or CTS deasserted).
+//==============================================================================
+SERIAL_TEMPLATE
+void SERIAL_PORT::handle_udre_interrupt() {
+    char flow_char = uart_flow_char;
+    if (flow_char) {
+        UART_DATA_REGISTER = flow_char;
+        uart_flow_char = 0;
+        return;
+    }
+
+    if (uart_tx_paused || (uart_cts_pin && (*uart_cts_pin & uart_cts_mask))) {
+        DISABLE_UART_UDRE_INTERRUPT(); // Resumed by XON or a CTS pin change
+        return;
+    }
+
+    uint8_t read_pos = uart_tx_read_pos;
+
+    if (read_pos != uart_tx_write_pos) {
+        UART_DATA_REGISTER = uart_tx_buffer[read_pos];
+        uart_tx_read_pos = (read_pos + 1) & tx_mask;
+    } else {
+        DISABLE_UART_UDRE_INTERRUPT(); // Nothing left to send
+    }
+}
+
+//==============================================================================
+// Interrupt Service Routines for UART receive and data register empty
+// Description: The handlers above are always_inline, so these ISRs contain
+//              no call and GCC does not save every call-clobbered register.
+//==============================================================================
+ISR(USART_RX_vect) {
+    Serial::handle_rx_interrupt();
+}
+
+ISR(USART_UDRE_vect) {
+    Serial::handle_udre_interrupt();
+}
+
+//==============================================================================
+// Static Method: handle_cts_interrupt
+// Description: Restarts transmission when the CTS pin is asserted again.
+//==============================================================================
+SERIAL_TEMPLATE
+void SERIAL_PORT::handle_cts_interrupt() {
+    if (uart_cts_pin && !(*uart_cts_pin & uart_cts_mask)) {
+        ENABLE_UART_UDRE_INTERRUPT();
+    }
+}
+
+//==============================================================================
+// Constructor: SerialPort
 // Description: Initializes the Serial object with the specified buffer
-//              size and checks if the UART is initialized in registers.
+//              sizes and checks if the UART is initialized in registers.
 //==============================================================================
-Serial::Serial() : initialized(IS_UART_ENABLED()) {}
+SERIAL_TEMPLATE
+SERIAL_PORT::SerialPort() 
+    : initialized(IS_UART_ENABLED()), _tx_policy(TX_BLOCK) {}
 
 //==============================================================================
-// Public Method: init
-// Description: This method initializes the UART module with the
-//              specified baud rate and data bits.
+// Private Method: _uart_init
+// Description: This method initializes the UART module with the baud rate
+//              register value computed by uart_init<baud_rate>() and the
+//              specified data bits.
 //==============================================================================
-void Serial::uart_init(const uint32_t& baud_rate, const uint8_t& data_bits){
+SERIAL_TEMPLATE
+void SERIAL_PORT::_uart_init(uint16_t ubrr, bool u2x, uint32_t baud_rate,
+                             uint8_t data_bits) {
     // Check if arguments are valid before initializing
-    if (valid_baud(baud_rate) && valid_bits(data_bits)) {
+    if (valid_bits(data_bits)) {
 
-        // Initialize UART using macro defined in ´config.h´
-        ENABLE_UART(baud_rate, data_bits);
+        // Initialize UART using macro defined in ´serial.h´
+        ENABLE_UART(ubrr, u2x, data_bits);
         initialized = true;
-        char buffer[64];
-        sprintf(buffer, 
-                "UART Initialized with %lu baud rate and %u-bits\r\n",
-                baud_rate, 
-                data_bits);
-        uart_put_str(buffer);
+        uart_printf_P(PSTR("UART Initialized with %lu baud rate and %u-bits\r\n"),
+                      baud_rate, data_bits);
 
         ENABLE_UART_RX_INTERRUPT(); // Enable UART receive interrupt
 
@@ -74,19 +305,37 @@ void Serial::uart_init(const uint32_t& baud_rate, const uint8_t& data_bits){
 //==============================================================================
 // Public Methods: put_char, put_str, uart_getchar, uart_rec_str
 // Description: These methods are used to transmit and receive data
-//              via UART.
+//              via UART. Transmitted data is queued in the TX buffer and
+//              sent by the UDRE interrupt, so callers only wait when the
+//              buffer is full and the TX policy is TX_BLOCK.
 //==============================================================================
 // Transmits a single character
-void Serial::uart_put_char(unsigned char data) {
+SERIAL_TEMPLATE
+void SERIAL_PORT::uart_put_char(unsigned char data) {
     // Return if UART is not initialized
     if (!initialized) return;
 
-    while (!(UCSR0A & (1<<UDRE0))); // Wait for empty transmit buffer
-    UDR0 = data;                    // Send data
+    if (_tx_enqueue(data)) return;
+
+    // Buffer is full - apply the configured policy
+    switch (_tx_policy) {
+        case TX_BLOCK:
+            while (!_tx_enqueue(data)) {
+                _tx_poll(); // Drain by hand if interrupts are disabled
+            }
+            break;
+        case TX_DROP:
+            uart_tx_dropped++;
+            break;
+        case TX_OVERWRITE:
+            _tx_overwrite(data);
+            break;
+    }
 }
 
 // Prints a string via USART
-void Serial::uart_put_str(const char* str) {
+SERIAL_TEMPLATE
+void SERIAL_PORT::uart_put_str(const char* str) {
     // Return if UART is not initialized
     if (!initialized) return;
 
@@ -95,61 +344,266 @@ void Serial::uart_put_str(const char* str) {
     }
 }
 
-bool Serial::uart_get_char(char* character) {
-    if (!initialized) {
+// Prints a string stored in program memory (PSTR/PROGMEM) via USART
+SERIAL_TEMPLATE
+void SERIAL_PORT::uart_put_str_P(const char* str) {
+    // Return if UART is not initialized
+    if (!initialized) return;
+
+    char c;
+    while ((c = pgm_read_byte(str++))) {
+        uart_put_char(c); // Transmit each character
+    }
+}
+
+// Prints a formatted string with the format stored in program memory.
+// Supports only %u, %lu, %d, %ld, %s (string in RAM) and %%, and writes
+// straight to the TX buffer without an intermediate string buffer.
+SERIAL_TEMPLATE
+void SERIAL_PORT::uart_printf_P(const char* format, ...) {
+    if (!initialized) return;
+
+    va_list args;
+    va_start(args, format);
+
+    char c;
+    while ((c = pgm_read_byte(format++))) {
+        if (c != '%') {
+            uart_put_char(c);
+            continue;
+        }
+
+        c = pgm_read_byte(format++);
+        switch (c) {
+            case 'u':
+                _put_uint(va_arg(args, unsigned int));
+                break;
+            case 'd': {
+                int value = va_arg(args, int);
+                if (value < 0) {
+                    uart_put_char('-');
+                    _put_uint(-(int32_t)value);
+                } else {
+                    _put_uint(value);
+                }
+                break;
+            }
+            case 'l':
+                c = pgm_read_byte(format);
+                if (c == 'd') {
+                    long value = va_arg(args, long);
+                    if (value < 0) {
+                        uart_put_char('-');
+                        _put_uint(-(uint32_t)value);
+                    } else {
+                        _put_uint(value);
+                    }
+                } else {
+                    _put_uint(va_arg(args, unsigned long));
+                }
+                if (c == 'u' || c == 'd') format++; // Skip the conversion
+                break;
+            case 's':
+                uart_put_str(va_arg(args, const char*));
+                break;
+            case '%':
+                uart_put_char('%');
+                break;
+            case '\0':
+                format--; // Lone '%' at the end of the format string
+                break;
+            default:
+                uart_put_char('%'); // Unsupported specifier, print as is
+                uart_put_char(c);
+                break;
+        }
+    }
+
+    va_end(args);
+}
+
+// Queues a single character, returns false if the TX buffer is full
+SERIAL_TEMPLATE
+bool SERIAL_PORT::uart_put_char_nb(unsigned char data) {
+    if (!initialized) return false;
+
+    if (!_tx_enqueue(data)) {
+        uart_tx_dropped++;
         return false;
     }
+    return true;
+}
+
+// Queues as much of the string as fits, returns the number of queued chars
+SERIAL_TEMPLATE
+uint8_t SERIAL_PORT::uart_put_str_nb(const char* str) {
+    if (!initialized) return 0;
+
+    uint8_t count = 0;
+    while (*str && uart_put_char_nb(*str++)) {
+        count++;
+    }
+    return count;
+}
+
+// Waits until every queued character has been handed to the UART
+SERIAL_TEMPLATE
+void SERIAL_PORT::uart_flush() {
+    if (!initialized) return;
+
+    while (uart_tx_read_pos != uart_tx_write_pos) {
+        _tx_poll();
+    }
+}
+
+SERIAL_TEMPLATE
+void SERIAL_PORT::set_tx_policy(TxPolicy policy) {
+    _tx_policy = policy;
+}
 
-    if (uart_read_pos != uart_write_pos) {
-        // There is data available
-        *character = uart_buffer[uart_read_pos++];
-        if (uart_read_pos >= buf_size) {
-            uart_read_pos = 0; // Wrap around if at the end of the buffer
+// Selects the flow control mode. For FLOW_RTSCTS, rts_pin and cts_pin are
+// two different digital pins (2-13, 0/1 are RXD/TXD); the CTS pin change
+// interrupt resumes transmission. The pin change interrupt of a previous
+// CTS pin is disabled first. Returns false (flow control off) for invalid
+// pins, or for FLOW_RTSCTS in builds without SERIAL_FLOW_RTSCTS.
+SERIAL_TEMPLATE
+bool SERIAL_PORT::set_flow_control(FlowControl mode, uint8_t rts_pin,
+                                   uint8_t cts_pin) {
+    bool valid = mode != FLOW_RTSCTS ||
+                 (SERIAL_FLOW_RTSCTS && rts_pin >= 2 && rts_pin <= 13 && cts_pin >= 2 && 
+                  cts_pin <= 13 && rts_pin != cts_pin);
+    if (!valid) mode = FLOW_NONE;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // Disable the pin change interrupt of the previous CTS pin
+        if (uart_cts_pin == &PIND) {
+            PCMSK2 &= ~uart_cts_mask;
+            if (!PCMSK2) PCICR &= ~(1 << PCIE2);
+        } else if (uart_cts_pin == &PINB) {
+            PCMSK0 &= ~uart_cts_mask;
+            if (!PCMSK0) PCICR &= ~(1 << PCIE0);
+        }
+
+        uart_flow = FLOW_NONE;
+        uart_rx_throttled = false;
+        uart_tx_paused = false;
+        uart_rts_port = nullptr;
+        uart_cts_pin = nullptr;
+
+        if (mode == FLOW_RTSCTS) {
+            GPIO rts(GPIO::DIGITAL_PIN, rts_pin);
+            GPIO cts(GPIO::DIGITAL_PIN, cts_pin);
+            rts.enable_output();
+            rts.set_low(); // Ready to receive
+            cts.enable_input();
+            cts.enable_pullup();
+
+            uart_rts_port = rts.port_register();
+            uart_rts_mask = rts.bit_mask();
+            uart_cts_pin  = cts.pin_register();
+            uart_cts_mask = cts.bit_mask();
+
+            // Pin change interrupt on CTS (PCMSK bits match the port bits)
+            if (cts_pin < 8) {
+                PCMSK2 |= uart_cts_mask;
+                PCICR  |= (1 << PCIE2);
+            } else {
+                PCMSK0 |= uart_cts_mask;
+                PCICR  |= (1 << PCIE0);
+            }
         }
-        return true; // Indicate that a character was read
+
+        uart_flow = mode;
+    }
+    return valid;
+}
+
+// Takes a consistent snapshot of the line error counters
+SERIAL_TEMPLATE
+void SERIAL_PORT::uart_line_stats(LineStats& stats) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        stats.framing_errors = uart_framing_errors;
+        stats.overrun_errors = uart_overrun_errors;
+        stats.parity_errors  = uart_parity_errors;
+        stats.ring_overflows = uart_ring_overflows;
+        stats.frame_errors   = uart_frame_errors;
+    }
+}
+
+// Counts an invalid binary frame, also one that decoded but held no valid
+// command (reported in LineStats::frame_errors)
+SERIAL_TEMPLATE
+void SERIAL_PORT::note_frame_error() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uart_frame_errors++;
+    }
+}
+
+// Transmits a received line straight from the RX buffer
+SERIAL_TEMPLATE
+void SERIAL_PORT::uart_put_line(const LineView& line) {
+    if (!initialized) return;
+
+    for (uint8_t i = 0; i < line.length(); i++) {
+        uart_put_char(line[i]);
+    }
+}
+
+// Reads the oldest pending line one character at a time ('\n' at the end)
+SERIAL_TEMPLATE
+bool SERIAL_PORT::uart_get_char(char* character) {
+    LineView line;
+    if (!uart_peek_line(line)) {
+        return false; // No complete line available to read
+    }
+
+    if (uart_line_cursor < line.length()) {
+        *character = line[uart_line_cursor++];
+    } else {
+        *character = '\n';  // End of line reached
+        uart_release_line(); // Free the line in the buffer
     }
-    return false; // No data was available to read
+    return true; // Indicate that a character was read
 }
 
-void Serial::uart_rec_str(char* buffer, const uint8_t& buf_size) {
+// Copies the oldest pending line into buffer and releases it (the buffer
+// size is checked at compile time by uart_rec_str)
+SERIAL_TEMPLATE
+void SERIAL_PORT::_rec_str(char* buffer, uint8_t size) {
     if (!initialized) {
         buffer[0] = '\0'; // Ensure the buffer is null-terminated
         return;
     }
 
-    // Make sure the buffer is <= specified BUFFER_SIZE
-    if (buf_size < Serial::buf_size) {
-        const char* error_msg = "Specified buffer size is too small!\n";
-        uart_put_str(error_msg);
-        buffer[0] = '\0'; // Ensure the buffer is null-terminated
+    LineView line;
+    if (!uart_peek_line(line)) {
+        buffer[0] = '\0'; // No complete line received yet
         return;
     }
 
     // Command longer than buffer size => buffer overflow...
-    if (uart_buffer_overflow) {
-        const char* error_msg = "Buffer overflowed, make sure your command is "
-                                "within buffer range!\n";
-        uart_put_str(error_msg);
+    if (line.overflowed()) {
+        uart_put_str_P(PSTR("Buffer overflowed, make sure your command is "
+                            "within buffer range!\n"));
         buffer[0] = '\0'; // Ensure the buffer is null-terminated
+        uart_release_line();
         return;
     }
 
     unsigned char charCount = 0;
 
-    // Loop until newline or buffer is full
-    while (uart_read_pos != uart_write_pos && charCount < (buf_size - 1)) {
-        // Read a character from the circular buffer
-        char receivedChar = uart_buffer[uart_read_pos++];
-        if (uart_read_pos >= buf_size) uart_read_pos = 0;
-
-        if (receivedChar == '\n') break;    // Stop on newline
-        buffer[charCount++] = receivedChar; // Store character
+    // Copy the line until its end or until the buffer is full
+    while (charCount < line.length() && charCount < (size - 1)) {
+        buffer[charCount] = line[charCount];
+        charCount++;
     }
 
     buffer[charCount] = '\0'; // Null-terminate the string
+    uart_release_line();
 }
 
-void Serial::uart_echo() {
+SERIAL_TEMPLATE
+void SERIAL_PORT::uart_echo() {
     char c;
     // Check if a character was successfully read
     if (uart_get_char(&c)) {
@@ -158,20 +612,230 @@ void Serial::uart_echo() {
 }
 
 //==============================================================================
-// Private Methods: valid_baud, valid_bits, valid_buf_size
-// Description: Using constexpr to validate baud rate, data bits, and
-//              buffer size at compile time for saving memory.
+// Public Methods: uart_lines_pending, uart_peek_line, uart_release_line
+// Description: Zero-copy access to complete lines queued by the RX interrupt.
+//              A peeked line stays in the RX buffer until it is released.
+//              uart_line_queued() is static so it can be handed to
+//              Power::idle() and checked with interrupts disabled; lines are
+//              only queued once the RX interrupt is enabled by uart_init.
 //==============================================================================
-constexpr bool Serial::valid_baud(uint32_t baud_rate) {
-    return baud_rate == 9600 || baud_rate == 19200 || baud_rate == 38400 ||
-           baud_rate == 57600 || baud_rate == 115200;
+SERIAL_TEMPLATE
+uint8_t SERIAL_PORT::uart_lines_pending() {
+    return initialized ? uart_line_count : 0;
+}
+
+SERIAL_TEMPLATE
+bool SERIAL_PORT::uart_line_queued() {
+    return uart_line_count != 0;
+}
+
+SERIAL_TEMPLATE
+bool SERIAL_PORT::uart_peek_line(LineView& line) {
+    if (!initialized || uart_line_count == 0) return false;
+
+    const volatile LineDesc& desc = uart_lines[uart_line_head];
+    line = LineView(desc.start, desc.length, desc.overflow, desc.frame);
+    return true;
 }
 
-constexpr bool Serial::valid_bits(uint8_t data_bits) {
+SERIAL_TEMPLATE
+void SERIAL_PORT::uart_release_line() {
+    if (uart_line_count == 0) return;
+
+    const volatile LineDesc& desc = uart_lines[uart_line_head];
+    uint8_t next_read_pos = (desc.start + desc.length) & rx_mask;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uart_read_pos  = next_read_pos; // Give the space back to the ISR
+        uart_line_head = (uart_line_head + 1) & line_mask;
+        uart_line_count--;
+
+        // Resume the sender once the buffer and the line queue have
+        // drained, or when no line is left whose release could resume it
+        uint8_t count = uart_line_count;
+        if (uart_rx_throttled && count < line_queue_size - 1 &&
+            (count == 0 ||
+             ((uart_write_pos - next_read_pos) & rx_mask) <= rx_low_water)) {
+            _set_rx_throttle(false);
+        }
+    }
+    uart_line_cursor = 0;
+}
+
+//==============================================================================
+// Public Methods: uart_read_frame, uart_put_frame
+// Description: Binary frame mode. A frame on the wire is 0x00, the COBS
+//              encoded payload followed by its CRC-16/XMODEM (little-endian)
+//              and a closing 0x00. uart_read_frame decodes a received frame
+//              into data and returns the payload length, or 0 (and counts
+//              the error) if the frame is malformed or fails the CRC.
+//==============================================================================
+SERIAL_TEMPLATE
+uint8_t SERIAL_PORT::uart_read_frame(const LineView& line, uint8_t* data,
+                                     uint8_t size) {
+    uint8_t length = 0;
+    uint8_t pos = 0;
+    bool valid = line.is_frame() && !line.overflowed();
+
+    // COBS decode: each code byte is followed by (code - 1) data bytes and
+    // an implicit zero, unless the code is 0xFF or it ends the frame
+    while (valid && pos < line.length()) {
+        uint8_t code = line[pos++];
+        if (code == 0) valid = false;
+
+        for (uint8_t i = 1; valid && i < code; i++) {
+            if (pos >= line.length() || length >= size) valid = false;
+            else data[length++] = line[pos++];
+        }
+
+        if (valid && code < 0xFF && pos < line.length()) {
+            if (length >= size) valid = false;
+            else data[length++] = 0;
+        }
+    }
+
+    // At least an opcode and the CRC, and the CRC must match
+    if (valid && length >= 3) {
+        length -= 2;
+        uint16_t crc = data[length] | ((uint16_t)data[length + 1] << 8);
+        if (crc == _crc16(data, length)) return length;
+    }
+
+    note_frame_error();
+    return 0;
+}
+
+SERIAL_TEMPLATE
+void SERIAL_PORT::uart_put_frame(const uint8_t* data, uint8_t length) {
+    if (!initialized) return;
+
+    uint16_t crc = _crc16(data, length);
+    uint16_t total = length + 2; // Payload followed by the CRC
+    uint16_t pos = 0;
+
+    // Returns the payload byte or CRC byte at the given position
+    auto byte_at = [&](uint16_t i) -> uint8_t {
+        if (i < length) return data[i];
+        return (i == length) ? (crc & 0xFF) : (crc >> 8);
+    };
+
+    uart_put_char(0); // Start delimiter
+
+    // COBS encode: emit each run of non-zero bytes behind its length code
+    do {
+        uint8_t run = 0;
+        while (pos + run < total && byte_at(pos + run) != 0 && run < 0xFE) {
+            run++;
+        }
+
+        uart_put_char(run + 1);
+        for (uint8_t i = 0; i < run; i++) {
+            uart_put_char(byte_at(pos + i));
+        }
+
+        pos += run;
+        if (run < 0xFE) pos++; // Skip the zero replaced by the code byte
+    } while (pos <= total);
+
+    uart_put_char(0); // End delimiter
+}
+
+//==============================================================================
+// Private Methods: _tx_enqueue, _tx_overwrite, _tx_poll
+// Description: TX circular buffer helpers. The write position is only
+//              touched by the main program and the read position only by
+//              the UDRE interrupt, except when overwriting the oldest byte.
+//==============================================================================
+SERIAL_TEMPLATE
+bool SERIAL_PORT::_tx_enqueue(unsigned char data) {
+    uint8_t write_pos = uart_tx_write_pos;
+    uint8_t next_pos = (write_pos + 1) & tx_mask;
+
+    if (next_pos == uart_tx_read_pos) return false; // Buffer is full
+
+    uart_tx_buffer[write_pos] = data;
+    uart_tx_write_pos = next_pos;
+    ENABLE_UART_UDRE_INTERRUPT(); // Make sure the buffer gets drained
+    return true;
+}
+
+SERIAL_TEMPLATE
+void SERIAL_PORT::_tx_overwrite(unsigned char data) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // Discard the oldest queued byte to make room for the new one
+        uart_tx_read_pos = (uart_tx_read_pos + 1) & tx_mask;
+        uart_tx_dropped++;
+        _tx_enqueue(data);
+    }
+}
+
+SERIAL_TEMPLATE
+void SERIAL_PORT::_tx_poll() {
+    // The UDRE interrupt drains the buffer when global interrupts are on.
+    // Flow control is not applied here, the host can't resume us while
+    // interrupts are disabled.
+    if (SREG & (1 << SREG_I)) return;
+
+    // Otherwise (e.g. inside a cli() section) send the next byte by hand
+    if (UCSR0A & (1 << UDRE0)) {
+        uint8_t read_pos = uart_tx_read_pos;
+        if (read_pos != uart_tx_write_pos) {
+            UART_DATA_REGISTER = uart_tx_buffer[read_pos];
+            uart_tx_read_pos = (read_pos + 1) & tx_mask;
+        }
+    }
+}
+
+//==============================================================================
+// Private Method: _put_uint
+// Description: Prints an unsigned value in decimal. Values that fit in 16
+//              bits use 16-bit division, which is much cheaper on the AVR.
+//==============================================================================
+SERIAL_TEMPLATE
+void SERIAL_PORT::_put_uint(uint32_t value) {
+    char digits[10];
+    uint8_t count = 0;
+
+    while (value > UINT16_MAX) {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    }
+
+    uint16_t value16 = value;
+    do {
+        digits[count++] = '0' + (value16 % 10);
+        value16 /= 10;
+    } while (value16);
+
+    while (count) {
+        uart_put_char(digits[--count]); // Most significant digit first
+    }
+}
+
+//==============================================================================
+// Private Method: _crc16
+// Description: CRC-16/XMODEM (poly 0x1021, init 0) over the frame payload.
+//==============================================================================
+SERIAL_TEMPLATE
+uint16_t SERIAL_PORT::_crc16(const uint8_t* data, uint8_t length) {
+    uint16_t crc = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        crc = _crc_xmodem_update(crc, data[i]);
+    }
+    return crc;
+}
+
+//==============================================================================
+// Private Method: valid_bits
+// Description: Using constexpr to validate data bits at compile time for
+//              saving memory. The baud rate is validated by UartBaud and the
+//              buffer sizes by static_asserts in serial.h.
+//==============================================================================
+SERIAL_TEMPLATE
+constexpr bool SERIAL_PORT::valid_bits(uint8_t data_bits) {
     return data_bits == 5 || data_bits == 6 || data_bits == 7 || 
            data_bits == 8 || data_bits == 9;
 }
 
-constexpr uint8_t Serial::valid_buf_size() {
-    return buf_size < 1 ? 1 : (Serial::buf_size >= 255 ? 255 : buf_size);
-}
\ No newline at end of file
+// Instantiate the configured UART driver
+template class SerialPort<SERIAL_RX_BUF_SIZE, SERIAL_TX_BUF_SIZE>;
\ No newline at end of file
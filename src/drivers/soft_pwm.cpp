@@ -0,0 +1,171 @@
+//==============================================================================
+// Software PWM (Bit-Angle Modulation) Implementation
+//==============================================================================
+#include "drivers/soft_pwm.h"
+#include "drivers/timer_resource.h"
+#include <util/atomic.h>
+
+// Static Members definitions
+uint8_t SoftPWM::_port[SoftPWM::MAX_CHANNELS] = {
+    NO_PORT, NO_PORT, NO_PORT, NO_PORT, NO_PORT, NO_PORT, NO_PORT,
+    NO_PORT, NO_PORT, NO_PORT, NO_PORT, NO_PORT, NO_PORT, NO_PORT,
+    NO_PORT, NO_PORT, NO_PORT, NO_PORT, NO_PORT, NO_PORT
+};
+uint8_t SoftPWM::_mask[SoftPWM::MAX_CHANNELS];
+uint8_t SoftPWM::_duty[SoftPWM::MAX_CHANNELS];
+volatile uint8_t SoftPWM::_port_mask[SoftPWM::PORTS] = { 0, 0, 0 };
+uint8_t SoftPWM::_planes[2][SoftPWM::BITS][SoftPWM::PORTS];
+volatile uint8_t SoftPWM::_front = 0;
+volatile bool SoftPWM::_swap = false;
+uint8_t SoftPWM::_bit = 0;
+uint8_t SoftPWM::_next_out[SoftPWM::PORTS];
+uint16_t SoftPWM::_next_ocr = SoftPWM::BASE_COUNTS - 1;
+volatile uint16_t SoftPWM::_late_slots = 0;
+
+//==============================================================================
+// Public Method: init
+// Description: Claim timer 1 and start the bit-angle slots (REFRESH_HZ PWM
+//              periods per second). Returns false if timer 1 is owned by
+//              another driver.
+//==============================================================================
+bool SoftPWM::init() {
+    if (!TimerResource::claim(Timer::TIMER1, TimerResource::SOFT_PWM,
+                              TimerResource::CHANNEL_A)) {
+        return false;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // Run a blank first slot, the first compare match starts slot 0
+        _bit = BITS - 1;
+        _prepare_next();
+        GPIOR0 |= (1 << RUNNING_BIT);
+        TCCR1A = 0;
+        TCCR1B = (1 << WGM12) | TIMER1_PS_BITS(PRESCALER); // CTC
+        OCR1A  = BASE_COUNTS - 1;
+        TCNT1  = 0;
+        TIFR1  = (1 << OCF1A);
+        TIMSK1 |= (1 << OCIE1A);
+    }
+    return true;
+}
+
+//==============================================================================
+// Public Method: stop
+// Description: Release timer 1 and drive every channel low. The channels and
+//              duty cycles are kept for the next init().
+//==============================================================================
+void SoftPWM::stop() {
+    if (TimerResource::owner(Timer::TIMER1) != TimerResource::SOFT_PWM) return;
+
+    // No compare match may run the Timer path on the SoftPWM registers
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        GPIOR0 &= ~(1 << RUNNING_BIT);
+        TimerResource::release(Timer::TIMER1, TimerResource::SOFT_PWM);
+        PORTB &= ~_port_mask[0];
+        PORTC &= ~_port_mask[1];
+        PORTD &= ~_port_mask[2];
+    }
+}
+
+//==============================================================================
+// Public Methods: add, remove
+// Description: Assign a digital pin (0-13, or 14-19 for A0-A5) to a channel as
+//              an output, starting at duty 0. A pin that is already used by
+//              another channel, or an invalid pin, is rejected, and so are
+//              pins 0/1 while the UART uses them (18 pins remain). remove()
+//              drives the pin low and leaves it as an output.
+//==============================================================================
+bool SoftPWM::add(uint8_t channel, uint8_t pin) {
+    if (channel >= MAX_CHANNELS || pin > MAX_PIN) return false;
+
+    // RXD/TXD belong to the UART while its receiver or transmitter is on
+    if (pin <= 1 && (UCSR0B & ((1 << RXEN0) | (1 << TXEN0)))) return false;
+
+    // Pins 0-7 are PORTD, 8-13 PORTB and 14-19 (A0-A5) PORTC
+    uint8_t port_idx = (pin < 8) ? 2 : (pin < 14) ? 0 : 1;
+    uint8_t mask = 1 << ((pin < 8) ? pin : (pin < 14) ? pin - 8 : pin - 14);
+
+    if (_port_mask[port_idx] & mask) return false;
+
+    remove(channel);
+
+    _duty[channel] = 0;
+    _mask[channel] = mask;
+    _port[channel] = port_idx;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        switch (port_idx) {
+            case 0: PORTB &= ~mask; DDRB |= mask; break;
+            case 1: PORTC &= ~mask; DDRC |= mask; break;
+            case 2: PORTD &= ~mask; DDRD |= mask; break;
+        }
+        _port_mask[port_idx] |= mask;
+    }
+    return true;
+}
+
+void SoftPWM::remove(uint8_t channel) {
+    if (channel >= MAX_CHANNELS || _port[channel] == NO_PORT) return;
+
+    uint8_t port_idx = _port[channel];
+    uint8_t mask = _mask[channel];
+    _port[channel] = NO_PORT;
+    _duty[channel] = 0;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _port_mask[port_idx] &= ~mask;
+        switch (port_idx) {
+            case 0: PORTB &= ~mask; break;
+            case 1: PORTC &= ~mask; break;
+            case 2: PORTD &= ~mask; break;
+        }
+    }
+    commit(); // Drop the pin from the bit planes
+}
+
+//==============================================================================
+// Public Methods: set_duty, duty, commit
+// Description: set_duty() only stages a duty cycle (0 off, 255 on), commit()
+//              rebuilds the bit planes in the back buffer and the ISR swaps
+//              them in at the start of the next PWM period, so all channels
+//              change together. The rebuild costs BITS x channels in the
+//              main loop and nothing in the ISR.
+//==============================================================================
+void SoftPWM::set_duty(uint8_t channel, uint8_t duty) {
+    if (channel < MAX_CHANNELS) _duty[channel] = duty;
+}
+
+uint8_t SoftPWM::duty(uint8_t channel) {
+    return channel < MAX_CHANNELS ? _duty[channel] : 0;
+}
+
+void SoftPWM::commit() {
+    _swap = false; // The back buffer is not read until the next swap
+    asm volatile("" ::: "memory"); // Keep the plane stores after the clear
+    uint8_t (*planes)[PORTS] = _planes[_front ^ 1];
+
+    for (uint8_t bit = 0; bit < BITS; bit++) {
+        uint8_t out[PORTS] = { 0, 0, 0 };
+        uint8_t bit_mask = (1 << bit);
+        for (uint8_t ch = 0; ch < MAX_CHANNELS; ch++) {
+            if (_port[ch] != NO_PORT && (_duty[ch] & bit_mask)) {
+                out[_port[ch]] |= _mask[ch];
+            }
+        }
+        for (uint8_t p = 0; p < PORTS; p++) planes[bit][p] = out[p];
+    }
+    asm volatile("" ::: "memory"); // _planes is not volatile, publish it first
+    _swap = true;
+}
+
+//==============================================================================
+// Public Method: late_count
+// Description: Number of slots whose compare interrupt ran after the counter
+//              had passed the new TOP (see handle_compare).
+//==============================================================================
+uint16_t SoftPWM::late_count() {
+    uint16_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        count = _late_slots;
+    }
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+//==============================================================================
+// Software Timer (Hashed Timer Wheel) Implementation
+//==============================================================================
+#include "drivers/soft_timer.h"
+
+// Static Members definitions
+SoftTimer* TimerWheel::_slots[TimerWheel::slots] = {};
+uint32_t TimerWheel::_last_tick = 0;
+uint8_t TimerWheel::_active = 0;
+
+//==============================================================================
+// SoftTimer Constructor / Destructor
+//==============================================================================
+SoftTimer::SoftTimer(Callback callback, void* context)
+    : _next(nullptr), _prev(nullptr), _expires(0), _period(0),
+      _callback(callback), _context(context), _active(false), _fired(false) {}
+
+SoftTimer::~SoftTimer() {
+    stop(); // Never leave a dangling node in the wheel
+}
+
+//==============================================================================
+// SoftTimer Public Methods: start, stop, expired
+// Description: start() (re)arms the timer to expire after delay ms, and
+//              every period ms after that if period is not 0. A delay of 0
+//              expires on the next tick.
+//==============================================================================
+void SoftTimer::start(uint32_t delay, uint32_t period) {
+    stop();
+    _period  = period;
+    _fired   = false;
+    _expires = SystemClock::millis() + (delay ? delay : 1);
+    TimerWheel::_insert(this);
+}
+
+void SoftTimer::stop() {
+    if (_active) TimerWheel::_remove(this);
+}
+
+bool SoftTimer::expired() {
+    if (!_fired) return false;
+    _fired = false;
+    return true;
+}
+
+//==============================================================================
+// Public Method: poll
+// Description: Visits the slots of every tick since the last poll (each slot
+//              at most once) and expires the timers that are due. Periodic
+//              timers are re-armed relative to their previous expiry so they
+//              do not drift, or relative to now if a full period was missed.
+//==============================================================================
+void TimerWheel::poll() {
+    uint32_t now = SystemClock::millis();
+    uint32_t ticks = now - _last_tick;
+    if (ticks == 0 || _active == 0) {
+        _last_tick = now;
+        return;
+    }
+    if (ticks > slots) ticks = slots;
+
+    for (uint32_t tick = now - ticks + 1; ticks; ticks--, tick++) {
+        uint8_t slot = tick & slot_mask;
+        SoftTimer* &head = _slots[slot];
+        SoftTimer* timer = head;
+        while (timer) {
+            SoftTimer* next = timer->_next; // timer may be re-inserted
+            if ((int32_t)(now - timer->_expires) >= 0) {
+                _expire(timer, now);
+                // A callback stopped the next timer or restarted it into
+                // another slot, rescan this slot from its head
+                if (next && (!next->_active || 
+                             (next->_expires & slot_mask) != slot)) {
+                    next = head;
+                }
+            }
+            timer = next;
+        }
+    }
+    _last_tick = now;
+}
+
+//==============================================================================
+// Public Method: pending
+// Description: True if there are active timers and a tick passed since the
+//              last poll(), i.e. the main loop should not go to sleep.
+//==============================================================================
+bool TimerWheel::pending() {
+    return _active && SystemClock::millis() != _last_tick;
+}
+
+//==============================================================================
+// Private Methods: _insert, _remove, _expire
+//==============================================================================
+void TimerWheel::_insert(SoftTimer* timer) {
+    SoftTimer* &head = _slots[timer->_expires & slot_mask];
+    timer->_prev = nullptr;
+    timer->_next = head;
+    if (head) head->_prev = timer;
+    head = timer;
+    timer->_active = true;
+    _active++;
+}
+
+void TimerWheel::_remove(SoftTimer* timer) {
+    if (timer->_prev) {
+        timer->_prev->_next = timer->_next;
+    } else {
+        _slots[timer->_expires & slot_mask] = timer->_next;
+    }
+    if (timer->_next) timer->_next->_prev = timer->_prev;
+    timer->_next = timer->_prev = nullptr;
+    timer->_active = false;
+    _active--;
+}
+
+void TimerWheel::_expire(SoftTimer* timer, uint32_t now) {
+    _remove(timer);
+    timer->_fired = true;
+
+    if (timer->_period) {
+        timer->_expires += timer->_period;
+        if ((int32_t)(now - timer->_expires) >= 0) {
+            timer->_expires = now + timer->_period; // Missed a full period
+        }
+        _insert(timer);
+    }
+
+    if (timer->_callback) timer->_callback(timer->_context);
+}
\ No newline at end of file
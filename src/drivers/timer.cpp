@@ -2,12 +2,21 @@
 // Timer Driver Class Implementation
 //==============================================================================
 #include "drivers/timer.h"
+#include "drivers/timer_resource.h"
+#include "drivers/soft_pwm.h"
+#include <util/atomic.h>
 
 // Static Singleton Instances
 Timer Timer::timer_0(Timer::TIMER0, Timer::MILLIS);
 Timer Timer::timer_1(Timer::TIMER1, Timer::MILLIS);
 Timer Timer::timer_2(Timer::TIMER2, Timer::MILLIS);
 
+// Input capture state
+volatile uint16_t Timer::_overflows = 0;
+volatile uint32_t Timer::_capture_ts[Timer::CAPTURE_SIZE];
+volatile uint8_t  Timer::_capture_rising = 0;
+volatile uint8_t  Timer::_capture_count = 0;
+
 //==============================================================================
 // Timer Public Method: getInstance
 // Description: Returns the Singletone instance of the timer based on the the 
@@ -28,51 +37,78 @@ Timer* Timer::get_instance(TimerNum num) {
 //              (MICROS, MILLIS) and initializes the timer accordingly.
 //==============================================================================
 Timer::Timer(TimerNum num, TimeUnit unit) 
-    : overflow_counter(0), interval_devisor(0), _num(num), _unit(unit) {
+    : overflow_counter(0), interval_devisor(0), temp_interval_devisor(0),
+      _num(num), _unit(unit), _on_interval(nullptr), _on_compare(nullptr),
+      _on_overflow(nullptr) {
 }
 
 //==============================================================================
 // Timer Public Method: configure
-// Description: Configure the timer with the given mode and interval.
+// Description: Configure the timer with the given mode and interval. The
+//              register settings come from solve(), either computed here or
+//              passed in pre-solved (at compile time for constant intervals).
+//              Interrupts are only disabled while the registers are written.
+//              Fails (with a message) if another driver owns the timer.
+//              EXT_CLOCK ignores the interval, the counter runs on the T1
+//              pin with the compare match at 0xFFFF.
 //==============================================================================
 void Timer::configure(TimerMode mode, uint32_t interval, Serial &serial) {
+    if (mode == EXT_CLOCK) {
+        const TimerSettings counter = { 0, 0, UINT16_MAX, 1, 0 };
+        configure(mode, counter, serial);
+        return;
+    }
+    configure(mode, solve(_num, _unit, interval), serial);
+}
+
+void Timer::configure(TimerMode mode, const TimerSettings &settings, 
+                      Serial &serial) {
+    if (!_claim(mode)) {
+        serial.uart_printf_P(PSTR("Timer %d is in use\r\n"), _num);
+        return;
+    }
+
     stop();                   // Stop the timer before setup 
     cli();                    // Disable interrupts temporarily
     _clear_prescaler_bits();  // Clear the prescaler bits
 
-    // Prescaler settings for ms and us (threshold)
-    uint16_t prescaler = set_prescaler(interval, serial);
-    uint32_t ocr_value = ((F_CPU / prescaler) * (_adjusted_interval / 
-                           (_unit == MICROS ? US_PER_SEC : MS_PER_SEC)) - 1);
-
-    // Inform user about the set pre-scaler and OCR value
-    char message[128];
-    snprintf(
-        message, sizeof(message),
-        "Timer %d configured for interval %lu%s (Prescaler: %d, OCR: %lu)\r\n",
-        _num, interval, (_unit == Timer::MICROS ? "us" : "ms"), prescaler, ocr_value
-    );
-    serial.uart_put_str(message);
-
     // Set the register values based on the set timer number
     switch (_num) {
         case TIMER0: 
-            OCR0A = ocr_value;
-            TCCR0B |= TIMER0_PS_BITS(prescaler);
+            OCR0A = settings.ocr;
+            TCCR0B |= TIMER0_PS_BITS(settings.prescaler);
             break;
         case TIMER1:
-            OCR1A = ocr_value;
-            TCCR1B |= TIMER1_PS_BITS(prescaler);
+            OCR1A = settings.ocr;
+            TCCR1B |= TIMER1_PS_BITS(settings.prescaler);
             break;
         case TIMER2: 
-            OCR2A = ocr_value;
-            TCCR2B |= TIMER2_PS_BITS(prescaler);
+            OCR2A = settings.ocr;
+            TCCR2B |= TIMER2_PS_BITS(settings.prescaler);
             break;
     }
 
+    // Compare matches per interval, counted down by the ISR
+    interval_devisor = settings.divisor;
+    temp_interval_devisor = settings.divisor;
+
     set_mode(mode);    // Set Mode (NORMAL, CTC, EXT_CLOCK)
     sei();             // Re-enable interrupts
     start();           // Start the timer again
+
+    if (mode == EXT_CLOCK) {
+        serial.uart_printf_P(PSTR("Timer %d counting the external clock\r\n"),
+                             _num);
+        return;
+    }
+
+    // Inform user about the set pre-scaler, OCR value and period error
+    serial.uart_printf_P(
+        PSTR("Timer %d configured for interval %lu%s (Prescaler: %u, OCR: %u, "
+             "Divisor: %u, Error: %ldppm)\r\n"),
+        _num, settings.interval, (_unit == Timer::MICROS ? "us" : "ms"),
+        settings.prescaler, settings.ocr, settings.divisor, settings.error_ppm
+    );
 }
 
 //==============================================================================
@@ -98,34 +134,232 @@ void Timer::stop() {
     }
 }
 
+//==============================================================================
+// Timer Public Methods: attach, detach
+// Description: Register callbacks that run inside the compare match ISR, so
+//              periodic outputs do not wait for the main loop. on_interval
+//              runs once per configured interval, on_compare on every
+//              compare match. For a fixed handler prefer the link-time
+//              hooks (timerN_interval_hook), they avoid the indirect call.
+//==============================================================================
+void Timer::attach(Callback on_interval, Callback on_compare) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _on_interval = on_interval;
+        _on_compare = on_compare;
+    }
+}
+
+void Timer::detach() {
+    attach(nullptr, nullptr);
+}
+
+// Overflow callback, shared with the capture timestamps in TIMER1_OVF_vect.
+// The caller enables TOIE1 itself; pass nullptr to remove the callback.
+void Timer::attach_overflow(Callback on_overflow) {
+    if (_num != TIMER1) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _on_overflow = on_overflow;
+    }
+}
+
+//==============================================================================
+// Timer Public Methods: start_capture, stop_capture
+// Description: Run timer 1 from the CPU clock (62.5ns per count at 16MHz) and
+//              timestamp both edges on the ICP1 pin (PB0, Arduino pin 8).
+//              Overflows extend the timestamps to 32 bits (268s at 16MHz).
+//              The optional noise canceler delays each capture by 4 cycles.
+//              Returns false if timer 1 is owned by another driver.
+//==============================================================================
+bool Timer::start_capture(bool noise_canceler) {
+    // Only timer 1 has an input capture unit
+    if (_num != TIMER1 || !_claim(CAPTURE)) return false;
+
+    stop();                     // No compare match interrupts while capturing
+    cli();
+    _clear_prescaler_bits();
+    set_mode(CAPTURE);          // Re-enables interrupts
+
+    if (noise_canceler) {
+        TCCR1B |= (1 << ICNC1);
+    }
+    return true;
+}
+
+void Timer::stop_capture() {
+    // Releasing resets the timer, leave it alone if capture does not own it
+    if (TimerResource::owner(_num) == TimerResource::CAPTURE) release();
+}
+
+//==============================================================================
+// Timer Public Method: release
+// Description: Stop the timer and give it back to the resource manager if it
+//              is in a Timer mode (interval, counter or capture), so another
+//              driver can claim it. Does nothing if someone else owns it.
+//==============================================================================
+void Timer::release() {
+    TimerResource::Owner owner = TimerResource::owner(_num);
+
+    if (owner == TimerResource::INTERVAL || owner == TimerResource::COUNTER ||
+        owner == TimerResource::CAPTURE) {
+        stop();
+        TimerResource::release(_num, owner);
+    }
+}
+
+//==============================================================================
+// Timer Public Method: measure
+// Description: Averages the period and high time over the captured edges
+//              (up to CAPTURE_SIZE / 2 - 1 full periods, rising to rising)
+//              and consumes them, so each call only reports new edges.
+//              Returns false until at least one full period was captured.
+//==============================================================================
+bool Timer::measure(CaptureResult &result) {
+    uint32_t ts[CAPTURE_SIZE];
+    uint8_t rising, count;
+
+    cli();
+    count  = _capture_count;
+    rising = _capture_rising;
+    for (uint8_t i = 0; i < CAPTURE_SIZE; i++) ts[i] = _capture_ts[i];
+    _capture_count = 0;
+    sei();
+
+    // Walk the edges oldest first, from the first to the last rising edge
+    uint8_t edges = count < CAPTURE_SIZE ? count : CAPTURE_SIZE;
+    uint8_t first = count - edges;
+    uint32_t start = 0, last_rise = 0, high = 0;
+    uint8_t periods = 0;
+    bool started = false;
+
+    for (uint8_t i = first; i != count; i++) {
+        uint8_t idx = i & CAPTURE_MASK;
+        if (rising & (1 << idx)) {
+            if (started) {
+                periods++;
+            } else {
+                start = ts[idx];
+                started = true;
+            }
+            last_rise = ts[idx];
+        } else if (started) {
+            high += ts[idx] - last_rise; // Falling edge ends a high phase
+        }
+    }
+    // Only count the high phases of complete periods
+    if (started && !(rising & (1 << ((count - 1) & CAPTURE_MASK)))) {
+        high -= ts[(count - 1) & CAPTURE_MASK] - last_rise;
+    }
+    if (periods == 0) return false;
+
+    uint32_t span = last_rise - start; // CPU cycles over all periods
+    result.periods   = periods;
+    result.period_ns = (uint64_t)span * 1000000000ULL / F_CPU / periods;
+    result.high_ns   = (uint64_t)high * 1000000000ULL / F_CPU / periods;
+    result.freq_chz  = (uint64_t)F_CPU * 100 * periods / span;
+    result.duty      = (uint64_t)high * 1000 / span;
+    return true;
+}
+
 //==============================================================================
 // ISR Timer Compare Match A Implementation
+// Note: TIMER0_COMPA_vect is the system tick, see drivers/clock.cpp
 //==============================================================================
-ISR(TIMER0_COMPA_vect) {
-    Timer::handle_timer_interrupt(&Timer::timer_0);
+// Timer 1 has two handlers: SoftPWM slots make no calls, so their handler
+// only saves the registers it uses, while the Timer path calls out and
+// saves every call-clobbered register. avr-gcc saves them in the prologue
+// for any call in the body, so a branch alone would make every slot pay
+// for the calls. TIMER1_COMPA_vect is a naked dispatch on the SoftPWM
+// running bit in GPIOR0 instead (sbic leaves SREG and the registers alone).
+extern "C" void __vector_timer1_soft_pwm() __attribute__((signal, used));
+extern "C" void __vector_timer1_compare() __attribute__((signal, used));
+
+ISR(TIMER1_COMPA_vect, ISR_NAKED) {
+    asm volatile("sbic %[gpior], %[bit]" "\n\t"
+                 "jmp __vector_timer1_soft_pwm" "\n\t"
+                 "jmp __vector_timer1_compare"
+                 :: [gpior] "I" (_SFR_IO_ADDR(GPIOR0)),
+                    [bit] "I" (SoftPWM::RUNNING_BIT));
 }
 
-ISR(TIMER1_COMPA_vect) {
-    Timer::handle_timer_interrupt(&Timer::timer_1);
+void __vector_timer1_soft_pwm() {
+    SoftPWM::handle_compare();
+}
+
+void __vector_timer1_compare() {
+    if (timer1_compare_hook) timer1_compare_hook();
+    if (Timer::handle_timer_interrupt(&Timer::timer_1) && timer1_interval_hook) {
+        timer1_interval_hook();
+    }
 }
 
 ISR(TIMER2_COMPA_vect) {
-    Timer::handle_timer_interrupt(&Timer::timer_2);
+    if (timer2_compare_hook) timer2_compare_hook();
+    if (Timer::handle_timer_interrupt(&Timer::timer_2) && timer2_interval_hook) {
+        timer2_interval_hook();
+    }
 }
 
-// Static method to handle timer interrupt
-void Timer::handle_timer_interrupt(Timer* timer) {
+//==============================================================================
+// ISR Timer 1 Input Capture and Overflow Implementation
+//==============================================================================
+ISR(TIMER1_CAPT_vect) {
+    Timer::handle_capture_interrupt(&Timer::timer_1);
+}
+
+ISR(TIMER1_OVF_vect) {
+    Timer::handle_overflow_interrupt(&Timer::timer_1);
+}
+
+// Static method to handle timer interrupt, returns true once per interval
+bool Timer::handle_timer_interrupt(Timer* timer) {
+    if (timer->_on_compare) timer->_on_compare();
+
     if (timer->interval_devisor <= 1) {
         timer->overflow_counter++;
         timer->interval_devisor = timer->temp_interval_devisor;
+        if (timer->_on_interval) timer->_on_interval();
+        return true;
     } else {
         timer->interval_devisor--;
+        return false;
     }
 }
 
+// Static method to handle the input capture interrupt
+void Timer::handle_capture_interrupt(Timer* timer) {
+    uint16_t icr = ICR1;
+    uint16_t overflows = _overflows;
+
+    // An overflow is pending and happened before this capture
+    if ((TIFR1 & (1 << TOV1)) && icr < 0x8000) overflows++;
+
+    uint8_t idx = _capture_count & CAPTURE_MASK;
+    _capture_ts[idx] = ((uint32_t)overflows << 16) | icr;
+    if (TCCR1B & (1 << ICES1)) {
+        _capture_rising |= (1 << idx);
+    } else {
+        _capture_rising &= ~(1 << idx);
+    }
+    if (++_capture_count == 0) {
+        _capture_count = CAPTURE_SIZE; // Wrapped, keep the ring marked full
+    }
+    timer->captured_value = icr;
+
+    TCCR1B ^= (1 << ICES1); // Capture the opposite edge next
+    TIFR1 = (1 << ICF1);    // Changing the edge may set the capture flag
+}
+
+// Static method to handle the overflow interrupt (capture timestamp bits
+// and the attached overflow callback)
+void Timer::handle_overflow_interrupt(Timer* timer) {
+    _overflows++;
+    if (timer->_on_overflow) timer->_on_overflow();
+}
+
 //==============================================================================
 // Timer Private Method: set_mode
-// Description: Set the timer mode to NORMAL, CTC, or EXT_CLOCK.
+// Description: Set the timer mode to NORMAL, CTC, EXT_CLOCK or CAPTURE.
 //==============================================================================
 void Timer::set_mode(TimerMode mode) {
     cli(); // Disable global interrupts
@@ -139,15 +373,25 @@ void Timer::set_mode(TimerMode mode) {
             }
             break;
         case TIMER1:
-            // Clear mode bits and input capture edge select
+            // Clear mode bits, input capture edge select and interrupts
             TCCR1A &= ~((1 << WGM11) | (1 << WGM10));
             TCCR1B &= ~((1 << WGM13) | (1 << WGM12)) & ~((1 << ICES1));
+            TIMSK1 &= ~((1 << ICIE1) | (1 << TOIE1));
             if (mode == CTC) {
                 TCCR1B |= (1 << WGM12);
             } else if (mode == EXT_CLOCK) {
                 // Set the external clock mode & input capture edge select
                 TCCR1B |= (1 << ICES1) | (1 << CS12) | (1 << CS11);
                 TCNT1 = 0; // Reset the counter
+            } else if (mode == CAPTURE) {
+                // Normal mode at the CPU clock, first capture on a rising edge
+                DDRB &= ~(1 << DDB0); // ICP1 as input
+                TCCR1B |= (1 << ICES1) | (1 << CS10);
+                TCNT1 = 0;
+                _overflows = 0;
+                _capture_count = 0;
+                TIFR1 = (1 << ICF1) | (1 << TOV1);
+                TIMSK1 |= (1 << ICIE1) | (1 << TOIE1);
             }
             break;
         case TIMER2:
@@ -163,103 +407,17 @@ void Timer::set_mode(TimerMode mode) {
 }
 
 //==============================================================================
-// Timer Private Methods: set_prescaler
-// Description: Calculate the prescaler value based on the interval and return
-//              the prescaler value.
+// Timer Private Method: _claim
+// Description: Claim the timer for a mode, releasing the previous mode first
+//              so switching between Timer modes starts from reset registers.
 //==============================================================================
-uint16_t Timer::set_prescaler(uint32_t interval, Serial &serial) {
-    _adjusted_interval = interval; // Keep the original interval
-    interval_devisor = 1;          // Default to 0
-
-    /* 
-       Check if the interval is greater than the maximum interval that the timer
-       can handle. If so, find the largest divisor that will result in a value
-       under the maximum interval for least CPU usage. ISR will decrement the
-       divisor until it reaches 1 (no division). 
-    */
-
-    if (interval > MAX_INTERVAL) {
-        uint32_t best_result = 0;
-        // Loop to find the largest divisor with a result under MAX_INTERVAL
-        for (uint32_t divisor = 2; divisor <= interval; divisor++) {
-            if (interval % divisor == 0) {
-                uint32_t result = interval / divisor;
-                if (result <= MAX_INTERVAL && result > best_result) {
-                    best_result = result;
-                    interval_devisor = divisor;
-                    _adjusted_interval = result;
-                }
-            }
-        }
-        char buf[64];
-        if (best_result > 0) {
-            sprintf(buf, "Set Divisor: %d (Result %d%s)\r\n", interval_devisor, 
-                    _adjusted_interval, (_unit == Timer::MICROS ? "us" : "ms"));
-            serial.uart_put_str(buf);
-        }
-    }
-
-     /* 
-       These are manually set threshold values for the prescaler settings. 
-       The threshold is the maximum interval that the prescaler can handle. 
-       These are for now hardcoded values and should maybe be refactored to
-       be dynamically calculated based on the F_CPU and the prescaler
-       values. We also need to add the additional prescaler values 
-       available for timer_2! (prescaler 32 and 128 for ms timer!)
-    */
-
-    const Timer::PrescalerSettings ms_settings_8bit[] = {
-        {1, 64}, {4, 256}, {16, 1024}
-    };
-
-    const Timer::PrescalerSettings us_settings_8bit[] = {
-        {16, 1}, {128, 8}, {1024, 64}, {4096, 256}, {16384, 1024}
-    };
-
-    const Timer::PrescalerSettings ms_settings_16bit[] = {
-        {32, 8}, {262, 64}, {1048, 256}, {UINT32_MAX, 1024}
-    };
-
-    const Timer::PrescalerSettings us_settings_16bit[] = {
-        {4096, 1}, {32768, 8}, {262144, 64}, {1048567, 256}, {UINT32_MAX, 1024}
-    };
-
-    const Timer::PrescalerSettings* settings;
-    size_t num_settings;
-
-
-    // Set the settings based on the timer bit size and selected time unit
-    if (_unit == MICROS) {
-        if (_num == TIMER1) {
-            settings = us_settings_16bit;
-            num_settings = sizeof(us_settings_16bit) / sizeof(us_settings_16bit[0]);
-        } else {
-            settings = us_settings_8bit;
-            num_settings = sizeof(us_settings_8bit) / sizeof(us_settings_8bit[0]);
-        }
-    } else {
-        if (_num == TIMER1) {
-            settings = ms_settings_16bit;
-            num_settings = sizeof(ms_settings_16bit) / sizeof(ms_settings_16bit[0]);
-        } else {
-            settings = ms_settings_8bit;
-            num_settings = sizeof(ms_settings_8bit) / sizeof(ms_settings_8bit[0]);
-        }
-    }
-
-    uint16_t prescaler = 1024;  // Default to the highest prescaler (for safety)
-
-    // Check the interval vs thresholds to set the prescaler
-    for (size_t i = 0; i < num_settings; ++i) {
-        if (_adjusted_interval < settings[i].threshold) {
-            prescaler = settings[i].prescaler;
-            break;
-        }
-    }
-
-    temp_interval_devisor = interval_devisor; // Save the divisor for ISR
+bool Timer::_claim(TimerMode mode) {
+    TimerResource::Owner owner = (mode == EXT_CLOCK) ? TimerResource::COUNTER :
+                                 (mode == CAPTURE)   ? TimerResource::CAPTURE :
+                                                       TimerResource::INTERVAL;
 
-    return prescaler;
+    if (TimerResource::owner(_num) != owner) release();
+    return TimerResource::claim(_num, owner, TimerResource::CHANNEL_A);
 }
 
 //==============================================================================
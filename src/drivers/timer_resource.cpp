@@ -0,0 +1,88 @@
+//==============================================================================
+// Timer Resource Manager Implementation
+//==============================================================================
+#include "drivers/timer_resource.h"
+#include <util/atomic.h>
+
+// Static Members definitions
+TimerResource::Owner TimerResource::_owner[3] = {
+    TimerResource::reserved(Timer::TIMER0),
+    TimerResource::reserved(Timer::TIMER1),
+    TimerResource::reserved(Timer::TIMER2)
+};
+uint8_t TimerResource::_channels[3] = { 0, 0, 0 };
+
+//==============================================================================
+// Public Method: claim
+// Description: Claim channels of a timer for an owner. Succeeds if the timer
+//              is free or already owned by the same kind of owner (which then
+//              shares the mode), fails if another owner holds it. Claiming
+//              a channel the owner already has is allowed, so re-init works.
+//==============================================================================
+bool TimerResource::claim(Timer::TimerNum num, Owner owner, uint8_t channels) {
+    if (owner == FREE || reserved(num) != FREE) return false;
+
+    bool claimed = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (_owner[num] == FREE || _owner[num] == owner) {
+            _owner[num] = owner;
+            _channels[num] |= channels & CHANNEL_ALL;
+            claimed = true;
+        }
+    }
+    return claimed;
+}
+
+//==============================================================================
+// Public Method: release
+// Description: Release channels held by owner (nothing happens if it does not
+//              own the timer). The last release frees the timer and resets it.
+//==============================================================================
+void TimerResource::release(Timer::TimerNum num, Owner owner, uint8_t channels) {
+    if (reserved(num) != FREE) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (_owner[num] == owner) {
+            _channels[num] &= ~channels;
+            if (_channels[num] == 0) {
+                _owner[num] = FREE;
+                _reset(num);
+            }
+        }
+    }
+}
+
+//==============================================================================
+// Public Methods: owner, channels
+//==============================================================================
+TimerResource::Owner TimerResource::owner(Timer::TimerNum num) {
+    return _owner[num];
+}
+
+uint8_t TimerResource::channels(Timer::TimerNum num) {
+    return _channels[num];
+}
+
+//==============================================================================
+// Private Method: _reset
+// Description: Stop the clock, disconnect the outputs, disable the interrupts
+//              and clear the pending flags (register reset values).
+//==============================================================================
+void TimerResource::_reset(Timer::TimerNum num) {
+    switch (num) {
+        case Timer::TIMER0:
+            break; // Reserved, never reset
+        case Timer::TIMER1:
+            TCCR1B = 0;
+            TCCR1A = 0;
+            TIMSK1 = 0;
+            TIFR1  = (1 << ICF1) | (1 << OCF1B) | (1 << OCF1A) | (1 << TOV1);
+            break;
+        case Timer::TIMER2:
+            TCCR2B = 0;
+            TCCR2A = 0;
+            TIMSK2 = 0;
+            TIFR2  = (1 << OCF2B) | (1 << OCF2A) | (1 << TOV2);
+            break;
+    }
+}
\ No newline at end of file
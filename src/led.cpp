@@ -17,13 +17,18 @@ LED::LED(uint8_t pin, bool enable_pwm)
       _power(255),
       _blink_interval(0),
       _prev_blink_interval(0),
-      _prev_overflows(0),
-      _overflow_counter(0)
+      _adc_seq(0),
+      _adc_filter(),
+      _interval_hyst(INTERVAL_BAND),
+      _blink_timer(),
+      _sample_timer()
 {
     _gpio.enable_output(); // Set the GPIO pin as output
 
     if (enable_pwm) {
-        _pwm.init(); // Initialize PWM functionality if enabled
+        // Initialize PWM functionality if enabled, fall back to on/off if
+        // the pin's timer is not available
+        _pwm_enabled = _pwm.init();
     }
 }
 
@@ -76,55 +81,120 @@ bool LED::is_off() {
 }
 
 //==============================================================================
-// LED Public Methods: blink, adc_blink
+// LED Public Methods: blink, stop_blink, adc_blink
 // Description: These methods are used to blink the LED at a given
 //              interval. The blink method is used to blink the LED
 //              at a fixed interval, while the adc_blink method is used
-//              to blink the LED at an interval based on the ADC reading
+//              to blink the LED at an interval based on the ADC reading.
+//              stop_blink must be called when the LED leaves a blink mode,
+//              so the next blink starts a full interval from its entry and
+//              adc_blink takes its first sample one tick after its entry.
 //==============================================================================
-void LED::blink(uint16_t blink_interval, Timer &timer) {
-    // Return early if the timer has not reached threshold (blink_interval)
-    if (timer.overflow_counter < (_prev_overflows + blink_interval))
+void LED::blink(uint16_t blink_interval) {
+    // A new interval takes effect from the next toggle
+    if (!_blink_timer.is_active()) {
+        _blink_timer.start_periodic(blink_interval);
+    } else {
+        _blink_timer.set_period(blink_interval);
+    }
+
+    // Return early if the blink interval (ms) has not passed yet
+    if (!_blink_timer.expired())
         return;
 
     toggle(); // Toggle the LED
-    _prev_overflows = timer.overflow_counter; // Reset the overflow counter
 }
 
-void LED::adc_blink(Timer &timer, Serial &serial, 
+void LED::stop_blink() {
+    _blink_timer.stop();
+    _sample_timer.stop();
+}
+
+void LED::adc_blink(Serial &serial, 
                     const uint8_t &adc_ch, const uint16_t &max_interval) {
-    
-    _prev_blink_interval = _blink_interval;
-    uint16_t adc_reading = _adc.read_channel(adc_ch);
-    uint16_t adc_voltage = adc_reading;
-    _adc.convert_to_mv(adc_voltage);
-    _blink_interval = adc_voltage / 
-                     (ADConverter::MAX_INPUT_VOLTAGE / max_interval);
+
+    // The channel is sampled on every SystemClock tick by the scanner and
+    // decimated to ADC_OVERSAMPLE extra bits
+    if (!ADCScanner::is_running())
+        ADCScanner::start(&adc_ch, 1, ADCScanner::TRIGGER_TIMER0_COMPA, 
+                          ADC_OVERSAMPLE);
+
+    // Use the latest sample every ADC_SAMPLE_MS, starting on the next tick
+    if (!_sample_timer.is_active())
+        _sample_timer.start(0, ADC_SAMPLE_MS);
+
+    uint16_t adc_reading;
+    uint8_t seq;
+    if (_sample_timer.expired() && ADCScanner::read(adc_ch, adc_reading, seq) &&
+        seq != _adc_seq) {
+        _adc_seq = seq;
+        _prev_blink_interval = _blink_interval;
+        adc_reading = _adc_filter.update(adc_reading);
+        uint16_t adc_voltage = adc_reading;
+        _adc.convert_to_mv(adc_voltage, ADC_OVERSAMPLE);
+        _blink_interval = _interval_hyst.update(adc_voltage / 
+                         (ADConverter::MAX_INPUT_VOLTAGE / max_interval),
+                         max_interval);
+
+        // Notify if blink time has changed
+        if (_blink_interval != _prev_blink_interval) {
+            if (_blink_interval == 0) {
+                serial.uart_put_str_P(PSTR("Blink off. LED set to fixed light.\r\n"));
+            } else {
+                serial.uart_printf_P(
+                    PSTR("Blink interval: %ums (ADC value: %u, Voltage: %umV)\r\n"),
+                    _blink_interval, adc_reading, adc_voltage);
+            }
+        }
+    }
 
     if(_blink_interval == 0) {
+        _blink_timer.stop();
         turn_on();
     } else {
-        blink(_blink_interval, timer);
+        blink(_blink_interval);
     }
+}
 
-    // Notify if blink time has changed
-    if (_blink_interval != _prev_blink_interval) {
-        if (_blink_interval == 0) {
-            serial.uart_put_str("Blink off. LED set to fixed light.\r\n");
-        } else {
-            char message[64]; // Buffer to hold UART message
-            sprintf(message, 
-                    "Blink interval: %dms (ADC value: %d, Voltage: %dmV)\r\n",
-                    _blink_interval, adc_reading, adc_voltage);
-            serial.uart_put_str(message);
-        }
+// Without PWM (timer not available) the level is switched as in set_level
+void LED::set_power(const uint16_t &cycle_time) {
+    set_level(cycle_time);
+}
+
+// Set the brightness directly (without changing the on power), LEDs without
+// PWM are switched on from half brightness
+void LED::set_level(uint8_t level) {
+    if (_pwm_enabled) {
+        _pwm.set_duty_cycle(level);
+    } else if (level > UINT8_MAX / 2) {
+        _gpio.set_high();
+    } else {
+        _gpio.set_low();
     }
 }
 
-void LED::set_power(const uint16_t &cycle_time) {
-    _pwm.set_duty_cycle(cycle_time);
+// LEDs without PWM blink instead, on for half of the ramp cycle
+void LED::ramp_brightness(const uint16_t &cycle_time) {
+    if (_pwm_enabled) {
+        _pwm.ramp_output(cycle_time);
+    } else if (cycle_time >= 2) {
+        blink(cycle_time / 2);
+    }
 }
 
-void LED::ramp_brightness(const uint16_t &cycle_time, Timer &timer) {
-    _pwm.ramp_output(cycle_time, timer);
-}
\ No newline at end of file
+void LED::stop_ramp() {
+    _pwm.stop_ramp();
+}
+
+// Compile-time check that the blink interval hysteresis reaches both ends of
+// the range (0 is the fixed light) when the pot is turned slowly to them
+constexpr bool _interval_ends_reachable(uint16_t max) {
+    Hysteresis hyst(LED::INTERVAL_BAND);
+    for (uint16_t value = max; value > 0; value--) hyst.update(value, max);
+    if (hyst.update(0, max) != 0) return false;
+    for (uint16_t value = 0; value < max; value++) hyst.update(value, max);
+    return hyst.update(max, max) == max;
+}
+static_assert(_interval_ends_reachable(2) && _interval_ends_reachable(100) &&
+              _interval_ends_reachable(1000),
+              "Blink interval hysteresis cannot reach 0 or max");
\ No newline at end of file
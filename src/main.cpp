@@ -7,6 +7,17 @@
 // Part 3: ledpowerfreq <power> <freq>  (power: 0-255, freq: 200-5000)
 // Part 4: button
 // Part 5: ledramptime <time>           (time(ms): 0-5000)
+// Part 6: capture                      (measure the signal on pin 8 / ICP1)
+// Part 7: scope <channel> <threshold>  (channel: 0-7, threshold: 0-255)
+// Part 8: anim <pattern>               (pattern: 0-5, see Animation::Patterns)
+// Query:  uartstats                    (UART line error counters)
+// Query:  cpuload                      (CPU load over the last second)
+//
+// All commands can also be sent as COBS encoded binary frames, see
+// Serial::uart_read_frame and Command::parse_frame. The USER animation
+// pattern can only be loaded with binary frames (ANIM_LOAD query, up to
+// Animation::LOAD_FRAMES keyframes per frame). The on-board LED (pin 13)
+// plays the heartbeat pattern while the firmware runs.
 //******************************************************************************
 // Wokwi Simulation: https://wokwi.com/projects/395865725914835969
 //==============================================================================
@@ -14,27 +25,46 @@
 #include <avr/interrupt.h>
 #include "drivers/serial.h"
 #include "drivers/timer.h"
+#include "drivers/clock.h"
+#include "drivers/timer_resource.h"
+#include "drivers/soft_timer.h"
+#include "drivers/power.h"
 #include "command.h"
 #include "led.h"
 #include "button.h"
+#include "animation.h"
 
 // Configuration Constants
 namespace cfg {
-    constexpr uint32_t baud_rate     = 9600;  // UART baud rate
+    constexpr uint32_t baud_rate     = 9600;  // UART baud rate (up to 1M)
     constexpr uint8_t  data_bits     = 8;     // data bits for UART
+    constexpr auto     flow_ctrl     = Serial::FLOW_NONE; // UART flow control
+    constexpr uint8_t  rts_pin       = 7;     // RTS pin (FLOW_RTSCTS only)
+    constexpr uint8_t  cts_pin       = 4;     // CTS pin (FLOW_RTSCTS only)
     constexpr uint8_t  pot_adc_ch    = 0;     // ADC channel for potentiometer
     constexpr uint8_t  led_pwm_pin   = 3;     // LED (PWM) pin
+    constexpr uint8_t  status_led_pin = 13;   // On-board status LED (no PWM)
     constexpr uint8_t  btn_pin       = 5;     // button pin
     constexpr uint16_t fixed_intvl    = 200;   // fixed LED blink interval (ms)
     constexpr uint16_t max_adc_intvl = 100;   // max ADC read interval (ms)
     constexpr uint16_t btn_intvl     = 1000;  // print button press Intvl (ms)
-    constexpr uint8_t  on_interrupt  = 1;     // timer (every interrupt)
-    constexpr uint8_t  ms_timer      = 1;     // timer (every ms)
+    constexpr uint8_t  scope_pre     = 64;    // scope samples before trigger
+
+    // Timer 0 is the system tick, timer 1 the button counter and capture
+    static_assert(TimerResource::pwm_pin_available(led_pwm_pin),
+                  "LED PWM pin must not be on timer 0 (system tick)");
+    static_assert(TimerResource::pwm_timer(led_pwm_pin) != Timer::TIMER1,
+                  "LED PWM pin must not be on timer 1 (button, capture)");
 }
 
 // Main loop declaration
-void loop(Serial &serial, LED &led, Button &btn, Timer* timer_0,
-          Timer* timer_1, Command &cmd);
+void loop(Serial &serial, LED &led, Button &btn, Timer* timer_1, Command &cmd);
+bool handle_frame(Serial &serial, Command &cmd, const LineView &line);
+void handle_query(Serial &serial, Command &cmd, bool binary);
+void send_query_reply(Serial &serial, uint8_t query, 
+                      const uint16_t* values, uint8_t count);
+void print_capture(Serial &serial, Timer &timer);
+void send_scope_block(Serial &serial, uint8_t block);
 
 //==============================================================================
 // Main (setup)
@@ -42,20 +72,26 @@ void loop(Serial &serial, LED &led, Button &btn, Timer* timer_0,
 int main(void) {
     Serial  serial;
     LED     led(cfg::led_pwm_pin, true);
+    LED     status_led(cfg::status_led_pin, false);
     Button  btn(cfg::btn_pin);
-    Timer*  timer_0 = Timer::get_instance(Timer::TIMER0);
     Timer*  timer_1 = Timer::get_instance(Timer::TIMER1);
     Command cmd;
 
     // Initialize the modules
-    serial.uart_init(cfg::baud_rate, cfg::data_bits);
+    serial.uart_init<cfg::baud_rate>(cfg::data_bits);
+    if (!serial.set_flow_control(cfg::flow_ctrl, cfg::rts_pin, cfg::cts_pin)) {
+        serial.uart_put_str_P(PSTR("Invalid RTS/CTS pins or no "
+                                   "SERIAL_FLOW_RTSCTS, flow control off\r\n"));
+    }
     btn.init();
-    timer_0->configure(Timer::CTC, cfg::ms_timer, serial);
-    timer_1->configure(Timer::CTC, cfg::fixed_intvl, serial);
+    SystemClock::init(); // millis()/micros() time base (timer 0)
+    Power::init();       // gate unused peripherals, idle sleep
 
     sei(); // enable global interrupts
 
-    loop(serial, led, btn, timer_0, timer_1, cmd);
+    Animation::play(status_led, Animation::HEARTBEAT);
+
+    loop(serial, led, btn, timer_1, cmd);
     
     return 0;
 }
@@ -63,26 +99,37 @@ int main(void) {
 //==============================================================================
 // Main loop
 //==============================================================================
-void loop(Serial &serial, LED &led, Button &btn, Timer* timer_0, 
-          Timer* timer_1, Command &cmd) {
+void loop(Serial &serial, LED &led, Button &btn, Timer* timer_1, Command &cmd) {
     
-    char rec_cmd[serial.buf_size];   // buffer for received uart command
+    LineView rec_cmd;                // received uart command (in place)
     bool new_cmd = false;            // new command flag
+    SoftTimer report_timer;          // capture report interval
+    uint8_t scope_block = 0;         // next scope block to send
 
     while (true) {
-        // Check if a new command has been received over UART
-        if (serial.uart_command_ready) {
-            serial.uart_rec_str(rec_cmd, serial.buf_size);
-            cmd.parse_cmd(rec_cmd);
-            if (cmd.cmd) {
-                new_cmd = true;
-                serial.uart_put_str("Executing: ");
-                serial.uart_put_str(rec_cmd);
-                serial.uart_put_str("\r\n");
+        TimerWheel::poll(); // Expire the soft timers due since the last loop
+
+        // Handle the oldest pending command received over UART (one per loop)
+        if (serial.uart_peek_line(rec_cmd)) {
+            if (rec_cmd.is_frame()) {
+                new_cmd = handle_frame(serial, cmd, rec_cmd);
+            } else if (rec_cmd.overflowed()) {
+                serial.uart_put_str_P(PSTR("Buffer overflowed, make sure your "
+                                           "command is within buffer range!\r\n"));
             } else {
-                serial.uart_put_str("Invalid Command!\r\n");
+                cmd.parse_cmd(rec_cmd);
+                if (cmd.query) {
+                    handle_query(serial, cmd, false);
+                } else if (cmd.cmd) {
+                    new_cmd = true;
+                    serial.uart_put_str_P(PSTR("Executing: "));
+                    serial.uart_put_line(rec_cmd);
+                    serial.uart_put_str_P(PSTR("\r\n"));
+                } else {
+                    serial.uart_put_str_P(PSTR("Invalid Command!\r\n"));
+                }
             }
-            serial.uart_command_ready = false; // reset command ready flag
+            serial.uart_release_line(); // free the line in the uart buffer
         }
 
         /*
@@ -90,34 +137,39 @@ void loop(Serial &serial, LED &led, Button &btn, Timer* timer_0,
          * iteration until a new command is received. The new_cmd flag 
          * is used to ensure that some commands are only executed once, 
          * (such as when re-configuring the timers, or reset LED Power).
+         * All intervals are soft timers on the shared SystemClock tick.
         */
 
+        // Release the input capture unit, timer 1, ADC scanner and the LED
+        // and button soft timers when another command takes over
+        if (new_cmd && cmd.cmd != Command::CAPTURE) {
+            timer_1->stop_capture();
+            report_timer.stop();
+        }
+        if (new_cmd && cmd.cmd != Command::BUTTON) timer_1->release();
+        if (new_cmd && cmd.cmd != Command::LED_ADC) ADCScanner::stop();
+        if (new_cmd) ADCCapture::stop();
+        if (new_cmd) led.stop_blink();   // Blink modes restart their phase
+        if (new_cmd) btn.stop_report();  // So do the press reports
+        if (new_cmd && cmd.cmd != Command::LED_RAMP) led.stop_ramp();
+        if (new_cmd && cmd.cmd != Command::ANIMATE) Animation::stop(led);
+
         switch(cmd.cmd) {
             case Command::NO_CMD: break;
         /****************************** PART 1 ******************************/
             case Command::LED_BLINK:
-                if (new_cmd) {
-                    led.set_power(UINT8_MAX);
-                    timer_1->configure(Timer::CTC, cfg::fixed_intvl, serial);
-                }
-                led.blink(cfg::on_interrupt, *timer_1);
+                if (new_cmd) led.set_power(UINT8_MAX);
+                led.blink(cfg::fixed_intvl);
                 break;
         /****************************** PART 2 ******************************/
             case Command::LED_ADC:
-                if (new_cmd) {
-                    led.set_power(UINT8_MAX);
-                    timer_1->configure(Timer::CTC, cfg::ms_timer, serial);
-                }
-                led.adc_blink(*timer_1, serial, cfg::pot_adc_ch, 
-                                 cfg::max_adc_intvl);
+                if (new_cmd) led.set_power(UINT8_MAX);
+                led.adc_blink(serial, cfg::pot_adc_ch, cfg::max_adc_intvl);
                 break;
         /****************************** PART 3 ******************************/
             case Command::LED_PWR:
-                if (new_cmd) {
-                    timer_1->configure(Timer::CTC, cmd.cmd_val2, serial);
-                    led.set_power(cmd.cmd_val1);
-                }
-                led.blink(cfg::on_interrupt, *timer_1);
+                if (new_cmd) led.set_power(cmd.cmd_val1);
+                led.blink(cmd.cmd_val2);
                 break;
         /****************************** PART 4 ******************************/
             case Command::BUTTON:
@@ -125,17 +177,193 @@ void loop(Serial &serial, LED &led, Button &btn, Timer* timer_0,
                     led.turn_off();
                     timer_1->configure(Timer::EXT_CLOCK, 0, serial);
                 }
-                btn.print_presses(cfg::btn_intvl, *timer_0, serial);
+                btn.print_presses(cfg::btn_intvl, serial);
                 break;
         /****************************** PART 5 ******************************/
             case Command::LED_RAMP:
-                if (new_cmd)
-                    timer_1->configure(Timer::CTC, cfg::ms_timer, serial);
-                led.ramp_brightness(cmd.cmd_val1, *timer_1);
+                led.ramp_brightness(cmd.cmd_val1);
+                break;
+        /****************************** PART 6 ******************************/
+            case Command::CAPTURE:
+                if (new_cmd) {
+                    led.turn_off();
+                    timer_1->start_capture();
+                    report_timer.start_periodic(cfg::btn_intvl);
+                }
+                if (report_timer.expired()) print_capture(serial, *timer_1);
+                break;
+        /****************************** PART 7 ******************************/
+            case Command::SCOPE:
+                if (new_cmd) {
+                    scope_block = 0;
+                    if (!ADCCapture::start(cmd.cmd_val1, ADCCapture::DIV_16, 
+                                           cmd.cmd_val2, cfg::scope_pre)) {
+                        serial.uart_put_str_P(PSTR("ADC busy!\r\n"));
+                        cmd.cmd = Command::NO_CMD; // Nothing to wait for
+                        break;
+                    }
+                }
+                // Send one block per loop once the capture is complete
+                if (ADCCapture::is_done() && 
+                    scope_block < ADCCapture::BUFFER_SIZE / Command::SCOPE_BLOCK) {
+                    if (scope_block == 0) {
+                        ADCCapture::stop(); // Give the ADC back
+                        serial.uart_printf_P(PSTR("Scope: %u samples at %luHz, "
+                                                  "trigger at %u, %u late\r\n"),
+                                             ADCCapture::BUFFER_SIZE,
+                                             ADCCapture::sample_rate(),
+                                             cfg::scope_pre,
+                                             ADCCapture::late_count());
+                    }
+                    send_scope_block(serial, scope_block++);
+                }
+                break;
+        /****************************** PART 8 ******************************/
+            case Command::ANIMATE:
+                if (new_cmd && !Animation::play(led, cmd.cmd_val1)) {
+                    serial.uart_put_str_P(PSTR("Pattern not loaded!\r\n"));
+                }
                 break;
         /********************************************************************/
         }
 
+        // Sleep until the next interrupt if no command is waiting
+        if (!new_cmd) Power::idle(Serial::uart_line_queued);
+
         new_cmd = false; // Reset the new command flag
     }
+}
+
+//==============================================================================
+// Binary frame handler
+// Description: Decodes a binary command frame and replies with an ACK frame
+//              on success, or a NAK frame holding the invalid frame count.
+//==============================================================================
+bool handle_frame(Serial &serial, Command &cmd, const LineView &line) {
+    uint8_t frame[Serial::frame_max];
+    uint8_t length = serial.uart_read_frame(line, frame, sizeof(frame));
+
+    if (length && cmd.parse_frame(frame, length)) {
+        if (cmd.query) {
+            handle_query(serial, cmd, true); // reply carries the query data
+            return false;
+        }
+        uint8_t ack = Command::FRAME_ACK | frame[0];
+        serial.uart_put_frame(&ack, sizeof(ack));
+        return true;
+    }
+
+    if (length) serial.note_frame_error(); // valid frame, invalid command
+    Serial::LineStats stats;
+    serial.uart_line_stats(stats);
+    uint8_t nak[] = { Command::FRAME_NAK,
+                      (uint8_t)(stats.frame_errors & 0xFF),
+                      (uint8_t)(stats.frame_errors >> 8) };
+    serial.uart_put_frame(nak, sizeof(nak));
+    return false;
+}
+
+//==============================================================================
+// Query handler
+// Description: Reports the requested status as text, or as an ACK frame
+//              followed by little-endian uint16_t values for binary queries.
+//==============================================================================
+void handle_query(Serial &serial, Command &cmd, bool binary) {
+    switch (cmd.query) {
+        case Command::UART_STATS: {
+            Serial::LineStats stats;
+            serial.uart_line_stats(stats);
+            if (binary) {
+                uint16_t values[] = { stats.framing_errors, stats.overrun_errors,
+                                      stats.parity_errors, stats.ring_overflows,
+                                      stats.frame_errors };
+                send_query_reply(serial, cmd.query, values, 5);
+            } else {
+                serial.uart_printf_P(PSTR("UART errors: framing %u, overrun %u, "
+                                          "parity %u, overflow %u, frames %u\r\n"),
+                                     stats.framing_errors, stats.overrun_errors,
+                                     stats.parity_errors, stats.ring_overflows,
+                                     stats.frame_errors);
+            }
+            break;
+        }
+        case Command::CPU_LOAD: {
+            Power::LoadStats stats;
+            Power::load_stats(stats);
+            if (binary) {
+                uint16_t values[] = { stats.load, stats.wakeups, stats.window };
+                send_query_reply(serial, cmd.query, values, 3);
+            } else {
+                serial.uart_printf_P(PSTR("CPU load: %u.%u%% (%u wakeups in %ums)\r\n"),
+                                     stats.load / 10, stats.load % 10,
+                                     stats.wakeups, stats.window);
+            }
+            break;
+        }
+        case Command::ANIM_LOAD: {
+            uint16_t loaded = Animation::load(cmd.data, cmd.data_length);
+            if (binary) {
+                send_query_reply(serial, cmd.query, &loaded, 1);
+            } else {
+                serial.uart_put_str_P(loaded ? PSTR("Pattern loaded\r\n")
+                                             : PSTR("Invalid pattern!\r\n"));
+            }
+            break;
+        }
+        default: break;
+    }
+
+    cmd.query = Command::NO_QUERY; // Queries are handled once
+}
+
+//==============================================================================
+// Query reply
+// Description: Sends FRAME_ACK | FRAME_QUERY | query followed by the values
+//              as little-endian uint16_t.
+//==============================================================================
+void send_query_reply(Serial &serial, uint8_t query, 
+                      const uint16_t* values, uint8_t count) {
+    uint8_t reply[Serial::frame_max];
+    if (count > (sizeof(reply) - 1) / 2) return;
+
+    reply[0] = Command::FRAME_ACK | Command::FRAME_QUERY | query;
+    for (uint8_t i = 0; i < count; i++) {
+        reply[1 + 2 * i] = values[i] & 0xFF;
+        reply[2 + 2 * i] = values[i] >> 8;
+    }
+    serial.uart_put_frame(reply, 1 + 2 * count);
+}
+
+//==============================================================================
+// Capture report
+// Description: Prints the signal measured on ICP1 since the last report.
+//==============================================================================
+void print_capture(Serial &serial, Timer &timer) {
+    Timer::CaptureResult res;
+    if (!timer.measure(res)) {
+        serial.uart_put_str_P(PSTR("No signal on ICP1 (pin 8)\r\n"));
+        return;
+    }
+
+    uint8_t centi = res.freq_chz % 100;
+    serial.uart_printf_P(PSTR("Signal: %lu.%u%uHz, period %luns, high %luns, "
+                              "duty %u.%u%% (%u periods)\r\n"),
+                         res.freq_chz / 100, centi / 10, centi % 10,
+                         res.period_ns, res.high_ns, res.duty / 10, 
+                         res.duty % 10, res.periods);
+}
+
+//==============================================================================
+// Scope block
+// Description: Sends Command::SCOPE_BLOCK captured samples as a binary frame.
+//==============================================================================
+void send_scope_block(Serial &serial, uint8_t block) {
+    uint8_t frame[3 + Command::SCOPE_BLOCK];
+    frame[0] = Command::FRAME_ACK | Command::SCOPE;
+    frame[1] = block;
+    frame[2] = cfg::scope_pre;
+    for (uint8_t i = 0; i < Command::SCOPE_BLOCK; i++) {
+        frame[3 + i] = ADCCapture::sample(block * Command::SCOPE_BLOCK + i);
+    }
+    serial.uart_put_frame(frame, sizeof(frame));
 }
\ No newline at end of file